@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include "BenchData.h"
+#include "FlatAccountMap.h"
+
+struct BenchAccount
+{
+    AccountKey accNo;
+    double averageAmount;
+
+    explicit BenchAccount(const AccountKey& accNo)
+        : accNo(accNo)
+        , averageAmount(1.0)
+    {}
+};
+
+//latency of single lookups of random existing accounts, reported as p50 and p99 in nanoseconds
+template<typename Lookup>
+static void measureLookupLatency(benchmark::State& state, const std::vector<AccountKey>& keys, Lookup lookup)
+{
+    std::mt19937_64 gen(10);
+    std::vector<double> latencies;
+    latencies.reserve(1 << 20);
+
+    for(auto _ : state)
+    {
+        const AccountKey& key = keys[gen() % keys.size()];
+
+        auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(lookup(key));
+        auto end = std::chrono::steady_clock::now();
+
+        if(latencies.size() < latencies.capacity())
+            latencies.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["p50_ns"] = latencies[latencies.size() / 2];
+    state.counters["p99_ns"] = latencies[latencies.size() * 99 / 100];
+}
+
+static std::vector<AccountKey> benchKeys(size_t count)
+{
+    std::vector<AccountKey> keys;
+    keys.reserve(count);
+
+    for(size_t i = 0; i < count; ++i)
+        keys.push_back(AccountKey(benchAccountNumber(i)));
+
+    return keys;
+}
+
+static void BM_UnorderedMapLookup(benchmark::State& state)
+{
+    auto keys = benchKeys(static_cast<size_t>(state.range(0)));
+
+    std::unordered_map<AccountKey, std::unique_ptr<BenchAccount>, AccountKeyHash> accounts;
+    for(const auto& key : keys)
+        accounts.insert(std::make_pair(key, std::make_unique<BenchAccount>(key)));
+
+    measureLookupLatency(state, keys, [&](const AccountKey& key){ return accounts.find(key)->second->averageAmount; });
+}
+BENCHMARK(BM_UnorderedMapLookup)->RangeMultiplier(10)->Range(1000, 10000000);
+
+static void BM_FlatAccountMapLookup(benchmark::State& state)
+{
+    auto keys = benchKeys(static_cast<size_t>(state.range(0)));
+
+    FlatAccountMap<BenchAccount> accounts;
+    for(const auto& key : keys)
+        accounts.emplace(key);
+
+    //store's lookups are const, non-const find also checks whether record's chunk is shared
+    const FlatAccountMap<BenchAccount>& constAccounts = accounts;
+    measureLookupLatency(state, keys, [&](const AccountKey& key){ return constAccounts.find(key)->averageAmount; });
+}
+BENCHMARK(BM_FlatAccountMapLookup)->RangeMultiplier(10)->Range(1000, 10000000);
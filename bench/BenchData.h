@@ -0,0 +1,108 @@
+#ifndef BENCH_DATA
+#define BENCH_DATA
+
+#include <random>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "Database.h"
+
+//parameters of generated transactions data set
+struct DataSetParams
+{
+    size_t accountsCount;
+    size_t transactionsCount;
+    double duplicateRatio;      //part of transactions repeating (accNo, txNo) of an earlier one
+    double zipfExponent;        //skew of accounts distribution, 0 means uniform
+    unsigned int seed;
+};
+
+//26 digits account number built from account's index
+inline std::string benchAccountNumber(size_t index)
+{
+    std::string digits = std::to_string(index);
+
+    return "35102049" + std::string(18 - digits.size(), '0') + digits;
+}
+
+//scrambling sequential numbers to unique, not ordered transaction numbers in int range (multiplication by odd number is a bijection mod 2^31)
+inline unsigned int benchTxNo(unsigned int sequence)
+{
+    return (sequence * 2654435761u) & 0x7fffffffu;
+}
+
+//sampling accounts indexes with Zipf distribution (or uniform for zero exponent)
+class AccountSampler
+{
+public:
+    AccountSampler(size_t accountsCount, double zipfExponent)
+        : uniform(0, accountsCount - 1)
+        , zipf(zipfExponent > 0.0)
+    {
+        if(!zipf) return;
+
+        cdf.resize(accountsCount);
+
+        double sum = 0.0;
+        for(size_t i = 0; i < accountsCount; ++i)
+        {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), zipfExponent);
+            cdf[i] = sum;
+        }
+
+        for(double& val : cdf)
+            val /= sum;
+    }
+
+    template<typename Generator>
+    size_t operator()(Generator& gen)
+    {
+        if(!zipf) return uniform(gen);
+
+        double val = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+        size_t index = static_cast<size_t>(std::lower_bound(cdf.begin(), cdf.end(), val) - cdf.begin());
+
+        return std::min(index, cdf.size() - 1);
+    }
+
+private:
+    std::uniform_int_distribution<size_t> uniform;
+    std::vector<double> cdf;
+    bool zipf;
+};
+
+inline std::vector<Transaction> generateTransactions(const DataSetParams& params)
+{
+    std::mt19937_64 gen(params.seed);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    AccountSampler sampler(params.accountsCount, params.zipfExponent);
+
+    std::vector<std::string> accounts(params.accountsCount);
+    for(size_t i = 0; i < params.accountsCount; ++i)
+        accounts[i] = benchAccountNumber(i);
+
+    std::vector<unsigned int> accountsSequences(params.accountsCount, 0);
+
+    std::vector<Transaction> transactions;
+    transactions.reserve(params.transactionsCount);
+
+    for(size_t i = 0; i < params.transactionsCount; ++i)
+    {
+        size_t account = sampler(gen);
+        unsigned int& sequence = accountsSequences[account];
+        unsigned int txSequence;
+
+        if(sequence > 0 && chance(gen) < params.duplicateRatio)
+            txSequence = std::uniform_int_distribution<unsigned int>(0, sequence - 1)(gen);
+        else
+            txSequence = sequence++;
+
+        long long cents = static_cast<long long>(gen() % 2000000) - 1000000;
+        transactions.push_back({ accounts[account], benchTxNo(txSequence), cents / 100.0 });
+    }
+
+    return transactions;
+}
+
+#endif //BENCH_DATA
@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include "AmountAggregate.h"
+#include "FixedPointAmounts.h"
+
+//[amounts count] random amounts with two decimal digits, as doubles and as cents
+struct AmountsColumnFixture
+{
+    std::vector<double> amounts;
+    std::vector<int64_t> cents;
+
+    explicit AmountsColumnFixture(const benchmark::State& state)
+    {
+        const size_t count = static_cast<size_t>(state.range(0));
+        std::mt19937_64 gen(13);
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            cents.push_back(static_cast<int64_t>(gen() % 2000000) - 1000000);
+            amounts.push_back(static_cast<double>(cents.back()) / 100.0);
+        }
+    }
+};
+
+//exact 128-bit sum of cents, blocks are summed in 64 bits
+static void BM_SumCents(benchmark::State& state)
+{
+    AmountsColumnFixture fixture(state);
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(averageOfCents(sumCents(fixture.cents.data(), fixture.cents.size()), fixture.cents.size()));
+    }
+
+    state.SetBytesProcessed(state.iterations() * fixture.cents.size() * sizeof(int64_t));
+}
+BENCHMARK(BM_SumCents)->Arg(1000)->Arg(1000000);
+
+//compensated, overflow-safe sum of doubles used without fixed-point mode
+static void BM_AmountAggregateSum(benchmark::State& state)
+{
+    AmountsColumnFixture fixture(state);
+
+    for(auto _ : state)
+    {
+        AmountAggregate aggregate;
+        aggregate.add(fixture.amounts.data(), fixture.amounts.size());
+        benchmark::DoNotOptimize(aggregate.average());
+    }
+
+    state.SetBytesProcessed(state.iterations() * fixture.amounts.size() * sizeof(double));
+}
+BENCHMARK(BM_AmountAggregateSum)->Arg(1000)->Arg(1000000);
+
+//converting loaded amounts to cents, which fixed-point mode adds to loading
+static void BM_AmountsToCents(benchmark::State& state)
+{
+    AmountsColumnFixture fixture(state);
+
+    for(auto _ : state)
+    {
+        for(size_t i = 0; i < fixture.amounts.size(); ++i)
+            amountToCents(fixture.amounts[i], fixture.cents[i]);
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * fixture.amounts.size() * sizeof(double));
+}
+BENCHMARK(BM_AmountsToCents)->Arg(1000000);
@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+#include "BenchData.h"
+#include "TransactionStore.h"
+
+//store with [accounts count] accounts and [transactions count] transactions, scanned with [threads count] threads
+struct GlobalQueryFixture
+{
+    TransactionStore store;
+    size_t transactionsCount;
+
+    explicit GlobalQueryFixture(const benchmark::State& state)
+    {
+        const size_t accountsCount = static_cast<size_t>(state.range(0));
+        transactionsCount = static_cast<size_t>(state.range(1));
+
+        store.setTransactions(generateTransactions(DataSetParams{ accountsCount, transactionsCount, 0.0, 0.0, 11 }));
+        store.setThreadsCount(static_cast<unsigned int>(state.range(2)));
+    }
+};
+
+static void globalQueryArguments(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({ "accounts", "tx", "threads" });
+
+    for(int threads : { 1, 2, 4 })
+        bench->Args({ 1000, 10000000, threads })->Args({ 1000000, 10000000, threads });
+}
+
+//merging precomputed accounts' aggregates, cost depends on accounts count only
+static void BM_CalculateGlobalAggregate(benchmark::State& state)
+{
+    GlobalQueryFixture fixture(state);
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(fixture.store.calculateGlobalAggregate());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CalculateGlobalAggregate)->Apply(globalQueryArguments)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_FindTopAccounts(benchmark::State& state)
+{
+    GlobalQueryFixture fixture(state);
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(fixture.store.findTopAccounts(100, AccountRanking::TotalAmount));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FindTopAccounts)->Apply(globalQueryArguments)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//full scan of amounts columns, bytes processed give the scan bandwidth
+static void BM_CalculateAmountHistogram(benchmark::State& state)
+{
+    GlobalQueryFixture fixture(state);
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(fixture.store.calculateAmountHistogram(-10000.0, 10000.0, 64));
+    }
+
+    state.SetBytesProcessed(state.iterations() * fixture.transactionsCount * sizeof(double));
+}
+BENCHMARK(BM_CalculateAmountHistogram)->Apply(globalQueryArguments)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//the same histogram counted from views of all accounts with single thread, as it could be done outside the store
+static void BM_AmountHistogramFromViews(benchmark::State& state)
+{
+    GlobalQueryFixture fixture(state);
+    std::vector<std::string> accNos;
+    for(size_t i = 0; i < static_cast<size_t>(state.range(0)); ++i)
+        accNos.push_back(benchAccountNumber(i));
+
+    for(auto _ : state)
+    {
+        std::vector<size_t> counts(64);
+        for(const std::string& accNo : accNos)
+        {
+            TransactionsView view = fixture.store.tryFindTransactionsView(accNo).transactions;
+            for(size_t i = 0; i < view.size(); ++i)
+            {
+                const double amount = view.amounts()[i];
+                if(amount >= -10000.0 && amount < 10000.0)
+                    ++counts[std::min<size_t>(63, static_cast<size_t>((amount + 10000.0) / 20000.0 * 64))];
+            }
+        }
+
+        benchmark::DoNotOptimize(counts.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * fixture.transactionsCount * sizeof(double));
+}
+BENCHMARK(BM_AmountHistogramFromViews)->Args({ 1000, 10000000, 1 })->Args({ 1000000, 10000000, 1 })->Unit(benchmark::kMillisecond)->UseRealTime();
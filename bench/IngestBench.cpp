@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "BenchData.h"
+#include "TransactionStore.h"
+#include "CsvTransactionsReader.h"
+
+//text file with [transactions count] lines for 100 transactions per account, amounts have two decimal places
+struct CsvFile
+{
+    std::string path;
+    size_t size;
+
+    explicit CsvFile(size_t count)
+        : path("txstore_bench.csv")
+    {
+        std::ofstream file(path, std::ios::binary);
+        char amount[32];
+
+        for(const Transaction& trans : generateTransactions(DataSetParams{ count / 100, count, 0.01, 0.0, 5 }))
+        {
+            std::snprintf(amount, sizeof(amount), "%.2f", trans.amount);
+            file << trans.accNo << ',' << trans.txNo << ',' << amount << '\n';
+        }
+
+        size = static_cast<size_t>(file.tellp());
+    }
+
+    ~CsvFile()
+    {
+        std::remove(path.c_str());
+    }
+};
+
+//parsing alone, file is in page cache after the first iteration
+static void BM_ParseCsv(benchmark::State& state)
+{
+    CsvFile csv(static_cast<size_t>(state.range(0)));
+
+    for(auto _ : state)
+    {
+        int fd = ::open(csv.path.c_str(), O_RDONLY);
+        CsvTransactionsReader reader(fd);
+        TransactionRecord record;
+        double sum = 0.0;
+
+        while(reader.next(record))
+            sum += record.amount;
+
+        benchmark::DoNotOptimize(sum);
+        ::close(fd);
+    }
+
+    state.SetBytesProcessed(state.iterations() * csv.size);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParseCsv)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+//whole streaming load: parsing, validation, sorting, removing duplicates and averages
+static void BM_LoadTransactionsFromFile(benchmark::State& state)
+{
+    CsvFile csv(static_cast<size_t>(state.range(0)));
+    TransactionStore store;
+
+    for(auto _ : state)
+    {
+        store.loadTransactionsFromFile(csv.path);
+    }
+
+    state.SetBytesProcessed(state.iterations() * csv.size);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadTransactionsFromFile)->RangeMultiplier(10)->Range(100000, 1000000)->Unit(benchmark::kMillisecond);
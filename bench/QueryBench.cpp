@@ -0,0 +1,346 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <thread>
+#include "BenchData.h"
+#include "TransactionStore.h"
+
+//store loaded with [accounts count] accounts and [transactions per account] transactions, queried with Zipf skew
+struct QueryFixture
+{
+    TransactionStore store;
+    std::vector<Transaction> queries;
+
+    QueryFixture(const benchmark::State& state, double zipfExponent)
+    {
+        size_t accountsCount = static_cast<size_t>(state.range(0));
+        size_t perAccount = static_cast<size_t>(state.range(1));
+
+        store.setTransactions(generateTransactions(DataSetParams{ accountsCount, accountsCount * perAccount, 0.0, 0.0, 7 }));
+
+        //sequence numbers are assigned per account, so txNo of sequence < per account transactions count is mostly present
+        std::mt19937_64 gen(8);
+        AccountSampler sampler(accountsCount, zipfExponent);
+
+        queries.reserve(4096);
+        for(size_t i = 0; i < 4096; ++i)
+        {
+            unsigned int sequence = static_cast<unsigned int>(gen() % perAccount);
+            queries.push_back({ benchAccountNumber(sampler(gen)), benchTxNo(sequence), 0.0 });
+        }
+    }
+};
+
+static void queryArguments(benchmark::internal::Benchmark* bench)
+{
+    bench->Args({ 1000, 10 })->Args({ 1000, 1000 })->Args({ 100000, 10 })->Args({ 10000, 100 });
+}
+
+template<typename Query>
+static void runQueries(benchmark::State& state, double zipfExponent, Query query)
+{
+    QueryFixture fixture(state, zipfExponent);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        const Transaction& q = fixture.queries[i++ & 4095];
+        try
+        {
+            query(fixture.store, q);
+        }
+        catch(const std::exception&)
+        {}
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_FindTransaction(benchmark::State& state)
+{
+    runQueries(state, 0.0, [](TransactionStore& store, const Transaction& q){ 
+        benchmark::DoNotOptimize(store.findTransaction(q.accNo, static_cast<int>(q.txNo))); });
+}
+BENCHMARK(BM_FindTransaction)->Apply(queryArguments);
+
+static void BM_FindTransactions(benchmark::State& state)
+{
+    runQueries(state, 0.0, [](TransactionStore& store, const Transaction& q){ 
+        auto transactions = store.findTransactions(q.accNo);
+        benchmark::DoNotOptimize(transactions.data()); });
+}
+BENCHMARK(BM_FindTransactions)->Apply(queryArguments);
+
+static void BM_FindTransactionsView(benchmark::State& state)
+{
+    runQueries(state, 0.0, [](TransactionStore& store, const Transaction& q){ 
+        auto view = store.findTransactionsView(q.accNo);
+        benchmark::DoNotOptimize(view.txNos()); });
+}
+BENCHMARK(BM_FindTransactionsView)->Apply(queryArguments);
+
+static void BM_CalculateAverageAmount(benchmark::State& state)
+{
+    runQueries(state, 0.0, [](TransactionStore& store, const Transaction& q){ 
+        benchmark::DoNotOptimize(store.calculateAverageAmount(q.accNo)); });
+}
+BENCHMARK(BM_CalculateAverageAmount)->Apply(queryArguments);
+
+//average queries with accounts chosen with Zipf distribution (exponent 1.0), hot accounts stay in cache
+static void BM_CalculateAverageAmountZipf(benchmark::State& state)
+{
+    runQueries(state, 1.0, [](TransactionStore& store, const Transaction& q){ 
+        benchmark::DoNotOptimize(store.calculateAverageAmount(q.accNo)); });
+}
+BENCHMARK(BM_CalculateAverageAmountZipf)->Apply(queryArguments);
+
+//precomputed statistics block, single hash lookup
+static void BM_GetAccountStats(benchmark::State& state)
+{
+    runQueries(state, 0.0, [](TransactionStore& store, const Transaction& q){ 
+        benchmark::DoNotOptimize(store.getAccountStats(q.accNo)); });
+}
+BENCHMARK(BM_GetAccountStats)->Apply(queryArguments);
+
+//the same statistics calculated on every query from zero-copy view
+static void BM_AccountStatsFromView(benchmark::State& state)
+{
+    runQueries(state, 0.0, [](TransactionStore& store, const Transaction& q){ 
+        TransactionsView view = store.findTransactionsView(q.accNo);
+        AmountAggregate aggregate;
+        aggregate.add(view.amounts(), view.size());
+        benchmark::DoNotOptimize(calculateAccountStats(view.amounts(), view.size(), aggregate.maxAbs, 0.0, aggregate.average())); });
+}
+BENCHMARK(BM_AccountStatsFromView)->Apply(queryArguments);
+
+static void BM_AccountNumberStringHash(benchmark::State& state)
+{
+    std::string accNo = benchAccountNumber(123456);
+    std::hash<std::string> hasher;
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(accNo);
+        benchmark::DoNotOptimize(hasher(accNo));
+    }
+}
+BENCHMARK(BM_AccountNumberStringHash);
+
+static void BM_AccountKeyHash(benchmark::State& state)
+{
+    AccountKey key(benchAccountNumber(123456));
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(key);
+        benchmark::DoNotOptimize(key.hash());
+    }
+}
+BENCHMARK(BM_AccountKeyHash);
+
+//average queries in concurrent mode while other thread keeps reloading the store
+static void BM_CalculateAverageAmountDuringReload(benchmark::State& state)
+{
+    QueryFixture fixture(state, 0.0);
+    fixture.store.setConcurrentReads(true);
+
+    auto transactions = generateTransactions(DataSetParams{ static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(0) * state.range(1)), 0.0, 0.0, 7 });
+    std::atomic<bool> finished(false);
+    std::atomic<size_t> reloads(0);
+
+    std::thread writer([&](){
+        while(!finished.load())
+        {
+            fixture.store.setTransactions(transactions);
+            ++reloads;
+        }
+    });
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(fixture.store.calculateAverageAmount(fixture.queries[i++ & 4095].accNo));
+    }
+
+    finished.store(true);
+    writer.join();
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["reloads"] = static_cast<double>(reloads.load());
+}
+BENCHMARK(BM_CalculateAverageAmountDuringReload)->Args({ 1000, 10 })->Args({ 10000, 100 })->UseRealTime();
+
+//256 lookups per iteration, one by one or as batch, tables are bigger than cache so single lookups wait for memory
+//accounts are drawn at random, so some of them have no transactions and lookups miss
+static void batchArguments(benchmark::internal::Benchmark* bench)
+{
+    bench->Args({ 100000, 10 })->Args({ 1000000, 2 });
+}
+
+static void BM_CalculateAverageAmountLoop(benchmark::State& state)
+{
+    QueryFixture fixture(state, 0.0);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        for(size_t j = 0; j < 256; ++j)
+        {
+            try
+            {
+                benchmark::DoNotOptimize(fixture.store.calculateAverageAmount(fixture.queries[i++ & 4095].accNo));
+            }
+            catch(const std::exception&)
+            {}
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+BENCHMARK(BM_CalculateAverageAmountLoop)->Apply(batchArguments);
+
+static void BM_CalculateAverageAmountBatch(benchmark::State& state)
+{
+    QueryFixture fixture(state, 0.0);
+    std::vector<std::vector<std::string> > batches(16);
+
+    for(size_t i = 0; i < 4096; ++i)
+        batches[i / 256].push_back(fixture.queries[i].accNo);
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        auto results = fixture.store.calculateAverageAmountBatch(batches[i++ & 15]);
+        benchmark::DoNotOptimize(results.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+BENCHMARK(BM_CalculateAverageAmountBatch)->Apply(batchArguments);
+
+static void BM_FindTransactionLoop(benchmark::State& state)
+{
+    QueryFixture fixture(state, 0.0);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        for(size_t j = 0; j < 256; ++j)
+        {
+            const Transaction& q = fixture.queries[i++ & 4095];
+            try
+            {
+                benchmark::DoNotOptimize(fixture.store.findTransaction(q.accNo, static_cast<int>(q.txNo)));
+            }
+            catch(const std::exception&)
+            {}
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+BENCHMARK(BM_FindTransactionLoop)->Apply(batchArguments);
+
+static void BM_FindTransactionBatch(benchmark::State& state)
+{
+    QueryFixture fixture(state, 0.0);
+    std::vector<std::vector<TransactionQuery> > batches(16);
+
+    for(size_t i = 0; i < 4096; ++i)
+        batches[i / 256].push_back({ fixture.queries[i].accNo, static_cast<int>(fixture.queries[i].txNo) });
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        auto results = fixture.store.findTransactionBatch(batches[i++ & 15]);
+        benchmark::DoNotOptimize(results.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+BENCHMARK(BM_FindTransactionBatch)->Apply(batchArguments);
+
+//lookups with [miss percent] of queries missing (half missing account, half missing transaction),
+//throwing API pays for exception unwinding on every miss, try API only returns status
+struct MissFixture
+{
+    TransactionStore store;
+    std::vector<TransactionQuery> queries;
+
+    MissFixture(const benchmark::State& state, size_t accountsCount = 10000, double filterRate = 0.0, size_t queriesCount = 4096)
+    {
+        const size_t perAccount = 10;
+        store.setFilterFalsePositiveRate(filterRate);
+        store.setTransactions(generateTransactions(DataSetParams{ accountsCount, accountsCount * perAccount, 0.0, 0.0, 7 }));
+
+        std::mt19937_64 gen(9);
+        std::uniform_int_distribution<int> percent(0, 99);
+
+        for(size_t i = 0; i < queriesCount; ++i)
+        {
+            //accounts get perAccount transactions on average, first three almost always exist
+            size_t account = gen() % accountsCount;
+            unsigned int sequence = static_cast<unsigned int>(gen() % 3);
+
+            //every sequence number in (accountsCount * perAccount, 2 * accountsCount * perAccount) isn't used
+            if(percent(gen) < state.range(0))
+            {
+                if(i % 2 == 0) account += accountsCount;
+                else sequence += static_cast<unsigned int>(accountsCount * perAccount);
+            }
+
+            queries.push_back({ benchAccountNumber(account), static_cast<int>(benchTxNo(sequence)) });
+        }
+    }
+};
+
+static void BM_FindTransactionMisses(benchmark::State& state)
+{
+    MissFixture fixture(state);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        const TransactionQuery& q = fixture.queries[i++ & 4095];
+        try
+        {
+            benchmark::DoNotOptimize(fixture.store.findTransaction(q.accNo, q.txNo));
+        }
+        catch(const std::exception&)
+        {}
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FindTransactionMisses)->Arg(0)->Arg(30)->Arg(100);
+
+static void BM_TryFindTransactionMisses(benchmark::State& state)
+{
+    MissFixture fixture(state);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        const TransactionQuery& q = fixture.queries[i++ & 4095];
+        benchmark::DoNotOptimize(fixture.store.tryFindTransaction(q.accNo, q.txNo));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TryFindTransactionMisses)->Arg(0)->Arg(30)->Arg(100);
+
+//misses in store bigger than cache (queries touch most of it), with [filter] 0 - without filters, 1 - with 1% false positive rate filters
+static void BM_TryFindTransactionMissesFilter(benchmark::State& state)
+{
+    MissFixture fixture(state, 200000, state.range(1) ? 0.01 : 0.0, 1 << 16);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        const TransactionQuery& q = fixture.queries[i++ & 0xffff];
+        benchmark::DoNotOptimize(fixture.store.tryFindTransaction(q.accNo, q.txNo));
+    }
+
+    state.counters["filters_bytes"] = static_cast<double>(fixture.store.getStats().filtersMemoryUsage);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TryFindTransactionMissesFilter)->ArgNames({ "miss", "filter" })->Args({ 0, 0 })->Args({ 0, 1 })->Args({ 100, 0 })->Args({ 100, 1 });
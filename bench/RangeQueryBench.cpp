@@ -0,0 +1,157 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include "BenchData.h"
+#include "TransactionStore.h"
+
+//single account with 10^6 transactions numbered 0..10^6-1, queried with random ranges of [range width] txNos
+struct RangeFixture
+{
+    TransactionStore store;
+    std::string accNo;
+    std::vector<std::pair<unsigned int, unsigned int> > ranges;
+
+    explicit RangeFixture(const benchmark::State& state, bool fixedPoint = false)
+        : accNo(benchAccountNumber(0))
+    {
+        const unsigned int count = 1000000, width = static_cast<unsigned int>(state.range(0));
+        std::mt19937_64 gen(12);
+
+        std::vector<Transaction> transactions;
+        transactions.reserve(count);
+        for(unsigned int i = 0; i < count; ++i)
+            transactions.push_back({ accNo, i, static_cast<double>(gen() % 200000) / 100.0 });
+
+        store.setFixedPointAmounts(fixedPoint);
+        store.setTransactions(transactions);
+
+        for(size_t i = 0; i < 1024; ++i)
+        {
+            unsigned int lo = static_cast<unsigned int>(gen() % (count - width + 1));
+            ranges.push_back(std::make_pair(lo, lo + width));
+        }
+    }
+};
+
+static void BM_CalculateRangeAggregate(benchmark::State& state)
+{
+    RangeFixture fixture(state);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        const auto& range = fixture.ranges[i++ & 1023];
+        benchmark::DoNotOptimize(fixture.store.calculateRangeAggregate(fixture.accNo, range.first, range.second));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CalculateRangeAggregate)->RangeMultiplier(100)->Range(100, 1000000);
+
+//average only, boundary search and O(1) difference of prefix sums
+static void BM_CalculateAverageAmountInRange(benchmark::State& state)
+{
+    RangeFixture fixture(state);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        const auto& range = fixture.ranges[i++ & 1023];
+        benchmark::DoNotOptimize(fixture.store.calculateAverageAmount(fixture.accNo, range.first, range.second));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CalculateAverageAmountInRange)->RangeMultiplier(100)->Range(100, 1000000);
+
+//average from sparse prefix sums of cents, correctly rounded from exact sum
+static void BM_CalculateAverageAmountInRangeFixedPoint(benchmark::State& state)
+{
+    RangeFixture fixture(state, true);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        const auto& range = fixture.ranges[i++ & 1023];
+        benchmark::DoNotOptimize(fixture.store.calculateAverageAmount(fixture.accNo, range.first, range.second));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CalculateAverageAmountInRangeFixedPoint)->RangeMultiplier(100)->Range(100, 1000000);
+
+//balanced debits and credits, ranges with zero sum are answered from prefix sums too
+static void BM_CalculateAverageAmountBalancedRange(benchmark::State& state)
+{
+    TransactionStore store;
+    const std::string accNo = benchAccountNumber(0);
+    const unsigned int count = 4000000, width = static_cast<unsigned int>(state.range(0));
+
+    std::vector<Transaction> transactions;
+    transactions.reserve(count);
+    for(unsigned int i = 0; i < count; ++i)
+        transactions.push_back({ accNo, i, (i % 2 == 0) ? 1000.25 : -1000.25 });
+
+    store.setTransactions(transactions);
+
+    std::mt19937_64 gen(14);
+
+    for(auto _ : state)
+    {
+        unsigned int lo = static_cast<unsigned int>(gen() % (count - width)) & ~1u;
+        benchmark::DoNotOptimize(store.calculateAverageAmount(accNo, lo, lo + width));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CalculateAverageAmountBalancedRange)->Arg(1000)->Arg(2000000);
+
+//the same aggregate calculated from zero-copy range view
+static void BM_RangeAggregateFromView(benchmark::State& state)
+{
+    RangeFixture fixture(state);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        const auto& range = fixture.ranges[i++ & 1023];
+        auto view = fixture.store.findTransactionsInRange(fixture.accNo, range.first, range.second);
+
+        double sum = 0.0, minAmount = view.amounts()[0], maxAmount = minAmount;
+        for(size_t j = 0; j < view.size(); ++j)
+        {
+            sum += view.amounts()[j];
+            minAmount = std::min(minAmount, view.amounts()[j]);
+            maxAmount = std::max(maxAmount, view.amounts()[j]);
+        }
+
+        benchmark::DoNotOptimize(sum);
+        benchmark::DoNotOptimize(minAmount);
+        benchmark::DoNotOptimize(maxAmount);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RangeAggregateFromView)->RangeMultiplier(100)->Range(100, 1000000);
+
+//filtering copy of all account's transactions, which was the only way before range queries
+static void BM_RangeAggregateFromCopy(benchmark::State& state)
+{
+    RangeFixture fixture(state);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        const auto& range = fixture.ranges[i++ & 1023];
+        double sum = 0.0;
+
+        for(const Transaction& trans : fixture.store.findTransactions(fixture.accNo))
+            if(trans.txNo >= range.first && trans.txNo < range.second)
+                sum += trans.amount;
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RangeAggregateFromCopy)->Arg(100)->Unit(benchmark::kMillisecond);
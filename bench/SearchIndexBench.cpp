@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include "BenchData.h"
+#include "TransactionStore.h"
+#include "TransactionSearchIndex.h"
+
+//txNo column of single account with [transactions count] transactions, [clustered] 0 - sequential txNos with small
+//random gaps (interpolation), 1 - runs of consecutive txNos separated by big random gaps (Eytzinger),
+//queries are random existing txNos
+struct TxNoColumnFixture
+{
+    std::vector<unsigned int> txNos;
+    std::vector<unsigned int> queries;
+    TransactionSearchIndex index;
+
+    explicit TxNoColumnFixture(const benchmark::State& state)
+    {
+        const size_t count = static_cast<size_t>(state.range(0));
+        std::mt19937_64 gen(11);
+        txNos.reserve(count);
+
+        unsigned int txNo = 0;
+        for(size_t i = 0; i < count; ++i)
+        {
+            if(state.range(1) == 0)
+                txNo = static_cast<unsigned int>(i * 4 + gen() % 4);
+            else
+                txNo += (i % 64 == 0) ? 1 + static_cast<unsigned int>(gen() % 400) : 1;
+
+            txNos.push_back(txNo);
+        }
+
+        index.build(txNos.data(), txNos.size());
+
+        for(size_t i = 0; i < 65536; ++i)
+            queries.push_back(txNos[gen() % count]);
+    }
+};
+
+static void searchArguments(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({ "transactions", "clustered" });
+    for(long count : { 1000L, 100000L, 10000000L })
+        bench->Args({ count, 0 })->Args({ count, 1 });
+}
+
+//search with the index kind chosen for the column (binary, interpolation or Eytzinger)
+static void BM_TransactionSearchIndex(benchmark::State& state)
+{
+    TxNoColumnFixture fixture(state);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(fixture.index.find(fixture.txNos.data(), fixture.txNos.size(), fixture.queries[i++ & 0xffff]));
+    }
+
+    state.counters["index_bytes"] = static_cast<double>(fixture.index.memoryUsage());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransactionSearchIndex)->Apply(searchArguments);
+
+//std::lower_bound over the same column, which was used before the index
+static void BM_TransactionLowerBound(benchmark::State& state)
+{
+    TxNoColumnFixture fixture(state);
+    size_t i = 0;
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::lower_bound(fixture.txNos.begin(), fixture.txNos.end(), fixture.queries[i++ & 0xffff]));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransactionLowerBound)->Apply(searchArguments);
+
+//whole findTransaction path on the store with large account
+static void BM_FindTransactionLargeAccount(benchmark::State& state)
+{
+    TxNoColumnFixture fixture(state);
+    const std::string accNo = benchAccountNumber(0);
+
+    std::vector<Transaction> transactions;
+    transactions.reserve(fixture.txNos.size());
+    for(unsigned int txNo : fixture.txNos)
+        transactions.push_back({ accNo, txNo, 1.00 });
+
+    TransactionStore store;
+    store.setTransactions(transactions);
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(store.tryFindTransaction(accNo, static_cast<int>(fixture.queries[i++ & 0xffff])));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FindTransactionLargeAccount)->Apply(searchArguments);
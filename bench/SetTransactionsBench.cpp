@@ -0,0 +1,158 @@
+#include <benchmark/benchmark.h>
+#include "BenchData.h"
+#include "TransactionStore.h"
+
+static void runSetTransactions(benchmark::State& state, const DataSetParams& params, unsigned int threadsCount)
+{
+    auto transactions = generateTransactions(params);
+    TransactionStore store(threadsCount);
+
+    for(auto _ : state)
+    {
+        store.setTransactions(transactions);
+    }
+
+    state.SetItemsProcessed(state.iterations() * transactions.size());
+    state.counters["accounts"] = static_cast<double>(store.getStats().accountsCount);
+}
+
+//single account with n transactions, 10% of them are duplicates
+static void BM_SetTransactionsSingleAccount(benchmark::State& state)
+{
+    size_t count = static_cast<size_t>(state.range(0));
+    runSetTransactions(state, DataSetParams{ 1, count, 0.1, 0.0, 1 }, 1);
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_SetTransactionsSingleAccount)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond)->Complexity(benchmark::oNLogN);
+
+//10^6 transactions spread over [accounts count] accounts
+static void BM_SetTransactionsAccounts(benchmark::State& state)
+{
+    runSetTransactions(state, DataSetParams{ static_cast<size_t>(state.range(0)), 1000000, 0.0, 0.0, 2 }, 1);
+}
+BENCHMARK(BM_SetTransactionsAccounts)->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMillisecond);
+
+//[duplicates percent] of 10^6 transactions over 10^4 accounts are duplicates
+static void BM_SetTransactionsDuplicates(benchmark::State& state)
+{
+    runSetTransactions(state, DataSetParams{ 10000, 1000000, state.range(0) / 100.0, 0.0, 3 }, 1);
+}
+BENCHMARK(BM_SetTransactionsDuplicates)->DenseRange(0, 90, 30)->Unit(benchmark::kMillisecond);
+
+//10^6 transactions over 10^5 accounts with Zipf distribution of [exponent * 100]
+static void BM_SetTransactionsZipf(benchmark::State& state)
+{
+    runSetTransactions(state, DataSetParams{ 100000, 1000000, 0.0, state.range(0) / 100.0, 4 }, 1);
+}
+BENCHMARK(BM_SetTransactionsZipf)->Arg(0)->Arg(50)->Arg(100)->Arg(150)->Unit(benchmark::kMillisecond);
+
+//2*10^6 transactions over 10^5 accounts loaded with [threads count] threads
+static void BM_SetTransactionsThreads(benchmark::State& state)
+{
+    runSetTransactions(state, DataSetParams{ 100000, 2000000, 0.0, 0.0, 5 }, static_cast<unsigned int>(state.range(0)));
+}
+BENCHMARK(BM_SetTransactionsThreads)->RangeMultiplier(2)->Range(1, 32)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//10^6 transactions over [accounts count] accounts, columns [arena] 0 - on heap, 1 - carved from arena
+//(every iteration also releases data loaded by the previous one)
+static void BM_SetTransactionsArena(benchmark::State& state)
+{
+    auto transactions = generateTransactions(DataSetParams{ static_cast<size_t>(state.range(0)), 1000000, 0.0, 0.0, 9 });
+    TransactionStore store;
+    store.setArenaColumns(state.range(1) != 0);
+
+    for(auto _ : state)
+    {
+        store.setTransactions(transactions);
+    }
+
+    state.SetItemsProcessed(state.iterations() * transactions.size());
+    state.counters["bytes_per_tx"] = static_cast<double>(store.getStats().memoryUsage) / transactions.size();
+}
+BENCHMARK(BM_SetTransactionsArena)->ArgNames({ "accounts", "arena" })->ArgsProduct({ { 1000, 100000, 1000000 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+
+//4*10^6 transactions over [accounts count] accounts grouped and sorted with [radix] 0 - comparison sort, 1 - radix partitioning
+static void BM_SetTransactionsLoadAlgorithm(benchmark::State& state)
+{
+    auto transactions = generateTransactions(DataSetParams{ static_cast<size_t>(state.range(0)), 4000000, 0.05, 0.0, 10 });
+    TransactionStore store;
+    store.setLoadAlgorithm(state.range(1) != 0 ? LoadAlgorithm::RadixPartition : LoadAlgorithm::ComparisonSort);
+
+    for(auto _ : state)
+    {
+        store.setTransactions(transactions);
+    }
+
+    state.SetItemsProcessed(state.iterations() * transactions.size());
+}
+BENCHMARK(BM_SetTransactionsLoadAlgorithm)->ArgNames({ "accounts", "radix" })->ArgsProduct({ { 1, 1000, 100000 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+
+//appending batch of [batch size] new transactions to the store with 10^6 transactions over 10^4 accounts
+static void BM_AppendTransactions(benchmark::State& state)
+{
+    TransactionStore store;
+    store.setTransactions(generateTransactions(DataSetParams{ 10000, 1000000, 0.0, 0.0, 7 }));
+
+    std::mt19937_64 gen(8);
+    std::vector<Transaction> batch(static_cast<size_t>(state.range(0)));
+    unsigned int sequence = 1000000;
+
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        for(auto& trans : batch)
+            trans = { benchAccountNumber(gen() % 10000), benchTxNo(sequence++), 1.00 };
+        state.ResumeTiming();
+
+        store.appendTransactions(batch);
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch.size());
+}
+BENCHMARK(BM_AppendTransactions)->RangeMultiplier(10)->Range(10, 10000);
+
+//appending batch of 10 transactions with concurrent reads enabled to the store with 10^6 transactions over [accounts],
+//the published snapshot is copied, which shares all accounts but the touched ones
+static void BM_AppendTransactionsConcurrentReads(benchmark::State& state)
+{
+    const size_t accountsCount = static_cast<size_t>(state.range(0));
+
+    TransactionStore store;
+    store.setConcurrentReads(true);
+    store.setTransactions(generateTransactions(DataSetParams{ accountsCount, 1000000, 0.0, 0.0, 7 }));
+
+    std::mt19937_64 gen(8);
+    std::vector<Transaction> batch(10);
+    unsigned int sequence = 1000000;
+
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        for(auto& trans : batch)
+            trans = { benchAccountNumber(gen() % accountsCount), benchTxNo(sequence++), 1.00 };
+        state.ResumeTiming();
+
+        store.appendTransactions(batch);
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch.size());
+}
+BENCHMARK(BM_AppendTransactionsConcurrentReads)->ArgName("accounts")->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+//memory used by the store per loaded transaction, 100 transactions per account
+static void BM_MemoryPerTransaction(benchmark::State& state)
+{
+    size_t count = static_cast<size_t>(state.range(0));
+    auto transactions = generateTransactions(DataSetParams{ count / 100, count, 0.0, 0.0, 6 });
+
+    TransactionStore store;
+
+    for(auto _ : state)
+    {
+        store.setTransactions(transactions);
+    }
+
+    StoreStats stats = store.getStats();
+    state.counters["bytes_per_transaction"] = static_cast<double>(stats.memoryUsage) / stats.transactionsCount;
+}
+BENCHMARK(BM_MemoryPerTransaction)->Arg(1000000)->Unit(benchmark::kMillisecond)->Iterations(1);
@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include "BenchData.h"
+#include "TransactionStore.h"
+#include "MappedTransactionStore.h"
+
+static std::string benchSnapshotPath()
+{
+    return "txstore_bench.snapshot";
+}
+
+//start of the service from raw transactions: loading whole store and answering first query
+static void BM_StartupSetTransactions(benchmark::State& state)
+{
+    size_t count = static_cast<size_t>(state.range(0));
+    auto transactions = generateTransactions(DataSetParams{ count / 10, count, 0.0, 0.0, 7 });
+
+    for(auto _ : state)
+    {
+        TransactionStore store;
+        store.setTransactions(transactions);
+        benchmark::DoNotOptimize(store.calculateAverageAmount(benchAccountNumber(0)));
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_StartupSetTransactions)->RangeMultiplier(10)->Range(10000, 1000000)->Unit(benchmark::kMillisecond);
+
+//start of the service from snapshot file: mapping the file and answering first query
+//file stays in page cache between iterations, so disk reads aren't measured
+static void BM_StartupMappedSnapshot(benchmark::State& state)
+{
+    size_t count = static_cast<size_t>(state.range(0));
+    {
+        TransactionStore store;
+        store.setTransactions(generateTransactions(DataSetParams{ count / 10, count, 0.0, 0.0, 7 }));
+        store.saveSnapshot(benchSnapshotPath());
+    }
+
+    for(auto _ : state)
+    {
+        MappedTransactionStore store(benchSnapshotPath());
+        benchmark::DoNotOptimize(store.calculateAverageAmount(benchAccountNumber(0)));
+    }
+
+    std::remove(benchSnapshotPath().c_str());
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_StartupMappedSnapshot)->RangeMultiplier(10)->Range(10000, 1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_SaveSnapshot(benchmark::State& state)
+{
+    size_t count = static_cast<size_t>(state.range(0));
+    TransactionStore store;
+    store.setTransactions(generateTransactions(DataSetParams{ count / 10, count, 0.0, 0.0, 7 }));
+
+    for(auto _ : state)
+    {
+        store.saveSnapshot(benchSnapshotPath());
+    }
+
+    std::remove(benchSnapshotPath().c_str());
+    state.SetBytesProcessed(state.iterations() * count * (sizeof(unsigned int) + sizeof(double)));
+}
+BENCHMARK(BM_SaveSnapshot)->Arg(1000000)->Unit(benchmark::kMillisecond);
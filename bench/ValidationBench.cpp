@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>
+#include "BenchData.h"
+#include "AccountNumberValidator.h"
+
+static void BM_AccountNumberValidationScalar(benchmark::State& state)
+{
+    auto transactions = generateTransactions(DataSetParams{ 10000, 100000, 0.0, 0.0, 9 });
+
+    for(auto _ : state)
+    {
+        for(const auto& trans : transactions)
+            benchmark::DoNotOptimize(isAccountNumberValidScalar(trans.accNo.data(), trans.accNo.size()));
+    }
+
+    state.SetItemsProcessed(state.iterations() * transactions.size());
+}
+BENCHMARK(BM_AccountNumberValidationScalar);
+
+static void BM_AccountNumberValidation(benchmark::State& state)
+{
+    auto transactions = generateTransactions(DataSetParams{ 10000, 100000, 0.0, 0.0, 9 });
+
+    for(auto _ : state)
+    {
+        for(const auto& trans : transactions)
+            benchmark::DoNotOptimize(isAccountNumberValid(trans.accNo));
+    }
+
+    state.SetItemsProcessed(state.iterations() * transactions.size());
+}
+BENCHMARK(BM_AccountNumberValidation);
+
+static void BM_FindInvalidAccountNumbers(benchmark::State& state)
+{
+    auto transactions = generateTransactions(DataSetParams{ 10000, 100000, 0.0, 0.0, 9 });
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(findInvalidAccountNumbers(transactions));
+    }
+
+    state.SetItemsProcessed(state.iterations() * transactions.size());
+}
+BENCHMARK(BM_FindInvalidAccountNumbers);
@@ -0,0 +1,136 @@
+#ifndef ACCOUNT_KEY
+#define ACCOUNT_KEY
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "AccountNumberValidator.h"
+
+//account number kept inline in 32 bytes padded with zeros, correct account numbers never contain zero characters
+//so the padding also marks the length, key is built, compared and hashed as four 64 bit words without any allocation
+struct AccountKey
+{
+    static const size_t wordsCount = maxAccountNumberLength / sizeof(uint64_t);
+
+    uint64_t words[wordsCount];
+
+    AccountKey()
+        : words()
+    {}
+
+    //key of the account number, number has to be correct (see isAccountNumberValid)
+    explicit AccountKey(const std::string& accNo)
+    {
+        assign(accNo.data(), accNo.size());
+    }
+
+    //setting key from any string, returns false if string can't be a key of correct account number
+    //words are read with 8 byte loads, the last one ends at the string's end and is shifted [complexity: O(1)]
+    bool assign(const char* accNo, size_t length)
+    {
+        for(size_t i = 0; i < wordsCount; ++i)
+            words[i] = 0;
+
+        if(length > maxAccountNumberLength) return false;
+
+        if(length < sizeof(uint64_t))
+        {
+            std::memcpy(words, accNo, length);
+        }
+        else
+        {
+            for(size_t i = 0; i < wordsCount; ++i)
+            {
+                size_t begin = i * sizeof(uint64_t);
+
+                if(begin + sizeof(uint64_t) <= length)
+                    words[i] = loadWord(accNo + begin);
+                else if(begin < length)
+                    words[i] = loadWord(accNo + length - sizeof(uint64_t)) >> (8 * (begin + sizeof(uint64_t) - length));
+            }
+        }
+
+        //zero character inside the string would make it equal to the shorter one
+        return this->length() == length;
+    }
+
+    const char* data() const
+    {
+        return reinterpret_cast<const char*>(words);
+    }
+
+    //position of the first zero byte [complexity: O(1)]
+    size_t length() const
+    {
+        const uint64_t lowBits = 0x0101010101010101ull, highBits = 0x8080808080808080ull;
+
+        for(size_t i = 0; i < wordsCount; ++i)
+        {
+            uint64_t zeroBytes = (words[i] - lowBits) & ~words[i] & highBits;
+
+            if(zeroBytes != 0) return i * sizeof(uint64_t) + static_cast<size_t>(__builtin_ctzll(zeroBytes)) / 8;
+        }
+
+        return maxAccountNumberLength;
+    }
+
+    std::string toString() const
+    {
+        return std::string(data(), length());
+    }
+
+    //multiplications of the words are independent, so they're executed in parallel
+    uint64_t hash() const
+    {
+        uint64_t h = (words[0] * 0x9E3779B97F4A7C15ull) ^ rotate(words[1] * 0xC2B2AE3D27D4EB4Full, 16)
+            ^ rotate(words[2] * 0x165667B19E3779F9ull, 32) ^ rotate(words[3] * 0xD6E8FEB86659FD93ull, 48);
+
+        //murmur3 finalizer mixes all bits of the words into the lower ones
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+
+        return h;
+    }
+
+    bool operator==(const AccountKey& other) const
+    {
+        return ((words[0] ^ other.words[0]) | (words[1] ^ other.words[1]) | (words[2] ^ other.words[2]) | (words[3] ^ other.words[3])) == 0;
+    }
+
+    bool operator!=(const AccountKey& other) const
+    {
+        return !(*this == other);
+    }
+
+    //the same order as of account numbers' strings, zero padding is lower than any character
+    bool operator<(const AccountKey& other) const
+    {
+        return std::memcmp(words, other.words, sizeof(words)) < 0;
+    }
+
+private:
+    static uint64_t loadWord(const char* ptr)
+    {
+        uint64_t word;
+        std::memcpy(&word, ptr, sizeof(word));
+        return word;
+    }
+
+    static uint64_t rotate(uint64_t val, int bits)
+    {
+        return (val << bits) | (val >> (64 - bits));
+    }
+};
+
+struct AccountKeyHash
+{
+    size_t operator()(const AccountKey& key) const
+    {
+        return static_cast<size_t>(key.hash());
+    }
+};
+
+#endif //ACCOUNT_KEY
@@ -0,0 +1,24 @@
+#ifndef ACCOUNT_NUMBER_VALIDATOR
+#define ACCOUNT_NUMBER_VALIDATOR
+
+#include <string>
+#include <vector>
+#include "Database.h"
+
+const size_t maxAccountNumberLength = 32;
+
+//checking if account number is correct [1-32 alphanum], whole number is checked at once with SSE2 or AVX2 (chosen at runtime)
+bool isAccountNumberValid(const char* accNo, size_t length);
+
+inline bool isAccountNumberValid(const std::string& accNo)
+{
+    return isAccountNumberValid(accNo.data(), accNo.size());
+}
+
+//character by character version, used when no SIMD instructions are available
+bool isAccountNumberValidScalar(const char* accNo, size_t length);
+
+//checking account numbers of all transactions, returns indexes of transactions with incorrect ones
+std::vector<size_t> findInvalidAccountNumbers(const std::vector<Transaction>& transactions);
+
+#endif //ACCOUNT_NUMBER_VALIDATOR
@@ -0,0 +1,24 @@
+#ifndef ACCOUNT_STATS
+#define ACCOUNT_STATS
+
+#include <cstddef>
+
+//statistics of all account's amounts, precomputed while loading and appending
+//for account without transactions count, sum, average and variances are 0, minAmount and maxAmount are NaN
+struct AccountStats
+{
+    size_t count;
+    double sum;                 //can be infinite if the exact sum is beyond double's range, average is always finite
+    double average;
+    double minAmount;
+    double maxAmount;
+    double variance;            //population variance, can be infinite for amounts close to double's limit
+    double standardDeviation;   //always finite
+};
+
+//statistics of amounts with already calculated sum and average (compensated, or exact in fixed-point mode)
+//single lane-wise pass finds min, max and sum of squared deviations from the average (corrected two-pass variance)
+//deviations are scaled by power of two chosen by maxAbs, so squares can't overflow [complexity: O(n)]
+AccountStats calculateAccountStats(const double* amounts, size_t count, double maxAbs, double sum, double average);
+
+#endif //ACCOUNT_STATS
@@ -0,0 +1,34 @@
+#ifndef AMOUNT_AGGREGATE
+#define AMOUNT_AGGREGATE
+
+#include <cstddef>
+
+//compensated (Kahan-Babuska) sum and count of amounts, average can be updated in O(1) for every added amount
+//amounts are summed scaled by 2^scaleExp, scale is lowered only when the sum could exceed double's range
+struct AmountAggregate
+{
+    double sum;             //scaled sum of amounts
+    double compensation;    //lost low-order bits of the scaled sum
+    double maxAbs;          //largest absolute amount, chooses the scale
+    size_t count;
+    int scaleExp;
+
+    AmountAggregate()
+        : sum(0.0)
+        , compensation(0.0)
+        , maxAbs(0.0)
+        , count(0)
+        , scaleExp(0)
+    {}
+
+    void add(double amount);
+    void add(const double* amounts, size_t amountsCount);
+    void add(const AmountAggregate& other);
+
+    double average() const;
+
+private:
+    void rescale(double newMaxAbs, size_t newCount);
+};
+
+#endif //AMOUNT_AGGREGATE
@@ -0,0 +1,35 @@
+#ifndef AMOUNT_HISTOGRAM
+#define AMOUNT_HISTOGRAM
+
+#include <cstddef>
+#include <vector>
+
+//counts of amounts in equal buckets of [minAmount, maxAmount), amounts out of the range are counted separately
+//histograms with the same range and buckets can be merged, so every thread can fill its own one
+class AmountHistogram
+{
+public:
+    //throws std::invalid_argument if there are no buckets or the range is empty (or not finite)
+    AmountHistogram(double minAmount, double maxAmount, size_t bucketsCount);
+
+    //buckets of amounts are calculated for blocks of amounts first, so that loop can be vectorized [complexity: O(n)]
+    void add(const double* amounts, size_t count);
+    void add(const AmountHistogram& other);
+
+    double getMinAmount() const { return minAmount; }
+    double getMaxAmount() const { return maxAmount; }
+    size_t getBucketsCount() const { return counts.size() - 2; }
+
+    size_t getCount(size_t bucket) const { return counts[bucket + 1]; }
+    size_t getBelowCount() const { return counts.front(); }    //amounts below minAmount and NaN
+    size_t getAboveCount() const { return counts.back(); }     //amounts not below maxAmount
+
+private:
+    double minAmount;
+    double maxAmount;
+    double halfMinAmount;           //amounts are halved, so differences of amounts close to double's limit don't overflow
+    double bucketsPerHalfAmount;
+    std::vector<size_t> counts;     //below range, buckets, above range
+};
+
+#endif //AMOUNT_HISTOGRAM
@@ -0,0 +1,51 @@
+#ifndef AMOUNT_PREFIX_SUMS
+#define AMOUNT_PREFIX_SUMS
+
+#include <cstddef>
+#include <vector>
+#include "ColumnArena.h"
+
+//sparse prefix sums of account's amounts column, kept at starts of blocks of blockSize amounts
+//sum of any range is difference of two prefixes plus at most half of block summed directly at both ends
+//sums are scaled by 2^scaleExp of account's AmountAggregate, so no prefix sum can overflow,
+//and kept as double-double (high and low part) with the magnitude of bits which the low part couldn't keep,
+//so difference of prefixes is known to be exact whenever no bits were lost inside the range (e.g. zero sum of debits
+//and credits), only ranges which lost bits (amounts spanning more than ~106 bits, like ones close to double's limit
+//next to cents) and cancel out below that loss are summed block by block, scanning only blocks which lost bits
+class AmountPrefixSums
+{
+public:
+    static const size_t minPrefixCount = 64;   //smaller accounts are just summed
+    static const size_t blockSize = 16;        //[memory: 2 bytes per transaction]
+
+    AmountPrefixSums()
+        : scaleExp(0)
+    {}
+
+    //has to be rebuilt whenever amounts or account's scale change, prefixes are allocated in arena if it's given [complexity: O(n)]
+    void build(const double* amounts, size_t count, int scaleExp, ColumnArena* arena = nullptr);
+
+    //sum and average of amounts at positions [first, last) of the column which prefix sums were built for
+    //sum can be infinite if it's beyond double's range, average is always finite, 0 for empty range
+    //[complexity: O(blockSize), O((last - first) / blockSize) for ranges cancelling out below lost bits]
+    double sum(const double* amounts, size_t first, size_t last) const;
+    double average(const double* amounts, size_t first, size_t last) const;
+
+    size_t memoryUsage() const { return prefixes.capacity() * sizeof(Prefix); }
+
+private:
+    struct Prefix
+    {
+        double high;
+        double low;
+        double lost;            //sum of absolute values of bits lost by low part up to the prefix
+        double lossesCount;     //number of additions which lost bits (tiny loss can't change big lost sum)
+    };
+
+    ArenaVector<Prefix> prefixes;      //prefixes[i] is scaled sum of the first i * blockSize amounts
+    int scaleExp;
+
+    double scaledSum(const double* amounts, size_t first, size_t last) const;
+};
+
+#endif //AMOUNT_PREFIX_SUMS
@@ -0,0 +1,45 @@
+#ifndef AMOUNT_RANGE_TREE
+#define AMOUNT_RANGE_TREE
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "ColumnArena.h"
+
+//blocked segment tree of minimums and maximums over account's amounts column, leaves summarize blocks of leafSize amounts
+//min and max of any range of positions read at most two partial blocks and O(log(n)) nodes
+//(sums don't need the tree, they're taken from AmountPrefixSums)
+class AmountRangeTree
+{
+public:
+    static const size_t leafSize = 16;
+    static const size_t minTreeCount = 64;     //smaller accounts are just scanned
+
+    AmountRangeTree()
+        : leavesCount(0)
+    {}
+
+    //has to be rebuilt whenever amounts change, nodes are allocated in arena if it's given [complexity: O(n)]
+    void build(const double* amounts, size_t count, ColumnArena* arena = nullptr);
+
+    //minimum and maximum of amounts at positions [first, last) of the column which tree was built for, NaN for empty range
+    //[complexity: O(log(n))]
+    std::pair<double, double> minMax(const double* amounts, size_t first, size_t last) const;
+
+    size_t memoryUsage() const { return nodes.capacity() * sizeof(Node); }
+
+private:
+    struct Node
+    {
+        double minAmount;
+        double maxAmount;
+    };
+
+    ArenaVector<Node> nodes;        //bottom-up tree, leaves are at [leavesCount, 2 * leavesCount)
+    size_t leavesCount;
+
+    static void addAmounts(const double* amounts, size_t first, size_t last, Node& node);
+    static void addNode(const Node& other, Node& node);
+};
+
+#endif //AMOUNT_RANGE_TREE
@@ -0,0 +1,97 @@
+#ifndef BLOCKED_BLOOM_FILTER
+#define BLOCKED_BLOOM_FILTER
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+//blocked Bloom filter of 64 bit hashes, all bits of a hash are set in one 64 byte block, so a check touches one cache line
+//filter answers "surely not added" or "maybe added", empty (not built) filter answers "maybe" for everything
+//blocks are kept in shared pages, copy of filter shares them and add() clones only page it writes to
+class BlockedBloomFilter
+{
+public:
+    BlockedBloomFilter()
+        : blocksCount(0)
+        , bitsPerHash(0)
+        , capacity(0)
+        , added(0)
+    {}
+
+
+    //sizing filter for expected number of hashes and false positive rate (0 < rate < 1), previous content is cleared
+    void build(size_t expectedCount, double falsePositiveRate);
+    void clear();
+
+    void add(uint64_t hash);
+
+    //[complexity: O(1)]
+    bool mayContain(uint64_t hash) const
+    {
+        if(blocksCount == 0) return true;
+
+        const uint64_t* block = blockWords(hash);
+        uint32_t bit = firstBit(hash), step = bitStep(hash);
+        uint64_t missing = 0;
+
+        for(unsigned int i = 0; i < bitsPerHash; ++i, bit += step)
+            missing |= ~block[(bit >> 6) & 7] & (1ull << (bit & 63));
+
+        return missing == 0;
+    }
+
+    bool enabled() const { return blocksCount != 0; }
+
+    //number of added hashes above which false positive rate gets worse than configured
+    size_t getCapacity() const { return capacity; }
+    size_t getAddedCount() const { return added; }
+
+    //shared pages are counted in every filter sharing them
+    size_t memoryUsage() const { return blocksCount * blockWordsCount * sizeof(uint64_t); }
+
+    //hash of account's transaction, mixing account's hash with transaction number
+    static uint64_t transactionHash(uint64_t accountHash, unsigned int txNo)
+    {
+        uint64_t h = accountHash ^ (static_cast<uint64_t>(txNo) * 0x9E3779B97F4A7C15ull);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return h;
+    }
+
+private:
+    static const size_t blockWordsCount = 8;
+    static const unsigned int pageShift = 12;
+    static const size_t pageBlocks = size_t(1) << pageShift;     //256 KB of blocks per page
+
+    std::vector<std::shared_ptr<uint64_t> > pages;  //64 bytes aligned pages of blocks
+    size_t blocksCount;
+    unsigned int bitsPerHash;
+    size_t capacity;
+    size_t added;
+
+    //block chosen by high bits of hash, bits in block by double hashing of low bits
+    size_t blockIndex(uint64_t hash) const { return static_cast<size_t>(((hash >> 32) * blocksCount) >> 32); }
+
+    const uint64_t* blockWords(uint64_t hash) const
+    {
+        size_t block = blockIndex(hash);
+
+        return pages[block >> pageShift].get() + (block & (pageBlocks - 1)) * blockWordsCount;
+    }
+
+    //bytes of page, the last one has only remaining blocks
+    size_t pageBytes(size_t page) const
+    {
+        return std::min(pageBlocks, blocksCount - (page << pageShift)) * blockWordsCount * sizeof(uint64_t);
+    }
+
+    static std::shared_ptr<uint64_t> allocatePage(size_t bytes);
+
+    static uint32_t firstBit(uint64_t hash) { return static_cast<uint32_t>(hash); }
+    static uint32_t bitStep(uint64_t hash) { return static_cast<uint32_t>((hash * 0xC2B2AE3D27D4EB4Full) >> 32) | 1; }
+};
+
+#endif //BLOCKED_BLOOM_FILTER
@@ -0,0 +1,101 @@
+#ifndef COLUMN_ARENA
+#define COLUMN_ARENA
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+//bump allocator of accounts' columns and indexes, single allocations are never freed, all slabs are released with the arena
+//loading counts transactions of all accounts first and reserves one slab of exact size for all columns, indexes built
+//after sorting (whose sizes depend on deduplicated data) take following slabs
+class ColumnArena
+{
+public:
+    static const size_t minSlabSize = 1 << 20;     //slab for allocations beyond reserved size
+
+    ColumnArena()
+        : used(0)
+    {}
+
+    ColumnArena(const ColumnArena&) = delete;
+    ColumnArena& operator=(const ColumnArena&) = delete;
+
+    //adding slab for the next allocations of given total size (with alignment padding) [complexity: O(1)]
+    void reserve(size_t bytes);
+
+    void* allocate(size_t bytes, size_t alignment);
+
+    size_t memoryUsage() const;
+
+private:
+    struct Slab
+    {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Slab> slabs;
+    size_t used;                //bytes used in the last slab
+};
+
+//allocator of std::vector taking memory from arena, or from heap if there's no arena (default constructed)
+//copied containers use heap, moved and swapped ones take their arena along
+template<typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator()
+        : arena(nullptr)
+    {}
+
+    explicit ArenaAllocator(ColumnArena* arena)
+        : arena(arena)
+    {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+        : arena(other.getArena())
+    {}
+
+    T* allocate(size_t count)
+    {
+        if(arena == nullptr) return std::allocator<T>().allocate(count);
+
+        return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, size_t count)
+    {
+        if(arena == nullptr) std::allocator<T>().deallocate(pointer, count);
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    ColumnArena* getArena() const { return arena; }
+
+private:
+    ColumnArena* arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& first, const ArenaAllocator<U>& second) { return first.getArena() == second.getArena(); }
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& first, const ArenaAllocator<U>& second) { return first.getArena() != second.getArena(); }
+
+typedef std::vector<unsigned int, ArenaAllocator<unsigned int> > TxNoColumn;
+typedef std::vector<double, ArenaAllocator<double> > AmountColumn;
+typedef std::vector<int64_t, ArenaAllocator<int64_t> > CentsColumn;
+
+//array of account's index built over its columns, kept in the same arena as the columns
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+#endif //COLUMN_ARENA
@@ -0,0 +1,53 @@
+#ifndef CSV_TRANSACTIONS_READER
+#define CSV_TRANSACTIONS_READER
+
+#include <cstddef>
+#include <vector>
+
+//single parsed record, account number points into reader's buffer and is valid only until the next read
+struct TransactionRecord
+{
+    const char* accNo;
+    size_t accNoLength;
+    unsigned int txNo;
+    double amount;
+};
+
+//reader of "accNo,txNo,amount" lines from file descriptor, data is read in large chunks into one reused buffer
+//lines may end with \n or \r\n, empty lines are skipped, account numbers aren't validated here
+class CsvTransactionsReader
+{
+public:
+    static const size_t defaultChunkSize = 1 << 20;
+
+    //descriptor isn't closed by the reader
+    explicit CsvTransactionsReader(int fd, size_t chunkSize = defaultChunkSize);
+
+    //reading next record, returns false at the end of data, throws TransactionsFormatException on malformed line
+    //and std::system_error (with errno) when data can't be read
+    bool next(TransactionRecord& record);
+
+    size_t lineNumber() const { return line; }
+    size_t bytesRead() const { return totalRead; }
+
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t position;
+    size_t filled;
+    size_t line;
+    size_t totalRead;
+    bool endOfData;
+
+    void refill();
+    void parseLine(const char* first, const char* last, TransactionRecord& record) const;
+};
+
+//parsing transaction number, only decimal digits fitting in unsigned int are accepted
+bool parseTxNo(const char* first, const char* last, unsigned int& txNo);
+
+//parsing decimal amount, numbers with at most two decimal places are converted exactly from integer cents
+//(so "0.10" gives the same double as 0.10 literal), other formats fall back to strtod, only finite values are accepted
+bool parseAmount(const char* first, const char* last, double& amount);
+
+#endif //CSV_TRANSACTIONS_READER
@@ -12,6 +12,8 @@ struct Transaction {
 
 class Database {
 public:
+    virtual ~Database() = default;
+
     /**
      * Finds one transaction by its account number and transaction id.
      * If there are duplicates (by accNo, txNo) returns first matching.
@@ -0,0 +1,52 @@
+#ifndef EPOCH_RECLAMATION
+#define EPOCH_RECLAMATION
+
+#include <atomic>
+#include <cstdint>
+
+//epoch based reclamation for data read without locks (RCU-like)
+//readers announce the epoch they started in, writer after unpublishing data calls synchronize, which waits
+//until all readers that could still see that data have finished, after that data can be safely deleted
+class EpochDomain
+{
+public:
+    //reader's critical section, data read from published pointer stays valid until guard is destroyed
+    //guards can be nested, only the outermost one is announced
+    class ReadGuard
+    {
+    public:
+        ReadGuard();
+        ~ReadGuard();
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    //waiting for all readers which entered before the call [complexity: O(threads)]
+    static void synchronize();
+
+private:
+    //every slot takes its own cache line, so readers don't share lines
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<uint64_t> epoch;        //0 when thread is outside critical section
+        std::atomic<bool> used;
+        ReaderSlot* next;
+        unsigned int nesting;
+    };
+
+    struct ThreadSlot
+    {
+        ReaderSlot* slot;
+        ThreadSlot();
+        ~ThreadSlot();
+    };
+
+    static std::atomic<uint64_t> globalEpoch;
+    static std::atomic<ReaderSlot*> slots;          //lock-free list of slots, slots are reused after thread's exit
+
+    static ReaderSlot& threadSlot();
+    static ReaderSlot* acquireSlot();
+};
+
+#endif //EPOCH_RECLAMATION
@@ -0,0 +1,52 @@
+#ifndef FIXED_POINT_AMOUNTS
+#define FIXED_POINT_AMOUNTS
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ColumnArena.h"
+
+//amounts kept as integer number of cents, sums of cents are exact 128-bit integers
+//|amount| < 2^46, where double still has a distinct value for every cent, so |cents| < 2^53
+//and sum of 2^64 amounts can't overflow
+typedef __int128 CentsSum;
+
+const double maxFixedPointAmount = 70368744177664.0;
+
+//converting amount with at most two decimal digits to cents, false if it isn't such amount (or it's too big)
+bool amountToCents(double amount, int64_t& cents);
+
+//exact sum of cents, blocks are summed in 64 bits first, so the loop can be vectorized [complexity: O(n)]
+CentsSum sumCents(const int64_t* cents, size_t count);
+
+//amount (not cents) of exact sum, correctly rounded (nearest double to sum / 100)
+double sumOfCents(CentsSum sum);
+
+//average amount (not cents) of exact sum, correctly rounded (nearest double to sum / (100 * count)), 0 for no amounts
+double averageOfCents(CentsSum sum, size_t count);
+
+//exact sparse prefix sums of account's cents column, kept at starts of blocks of blockSize cents
+//sum of any range is difference of two prefixes plus at most half of block summed directly at both ends
+class CentsPrefixSums
+{
+public:
+    static const size_t minPrefixCount = 64;   //smaller accounts are just summed
+    static const size_t blockSize = 16;        //[memory: 1 byte per transaction]
+
+    //has to be rebuilt whenever cents change, prefixes are allocated in arena if it's given [complexity: O(n)]
+    void build(const int64_t* cents, size_t count, ColumnArena* arena = nullptr);
+
+    //sum and average amount of cents at positions [first, last) of the column which prefix sums were built for
+    //0 for empty range [complexity: O(blockSize)]
+    double sum(const int64_t* cents, size_t first, size_t last) const;
+    double average(const int64_t* cents, size_t first, size_t last) const;
+
+    size_t memoryUsage() const { return prefixes.capacity() * sizeof(CentsSum); }
+
+private:
+    ArenaVector<CentsSum> prefixes;     //prefixes[i] is sum of the first i * blockSize cents
+
+    CentsSum rangeSum(const int64_t* cents, size_t first, size_t last) const;
+};
+
+#endif //FIXED_POINT_AMOUNTS
@@ -0,0 +1,338 @@
+#ifndef FLAT_ACCOUNT_MAP
+#define FLAT_ACCOUNT_MAP
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include "AccountKey.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//open addressing hash map of account records (Swiss table layout), records are kept in insertion order
+//table keeps one control byte per slot (7 bits of key's hash or empty mark) and record's address, control bytes
+//are probed in groups of 16 with one SSE2 compare, so lookup usually touches one group, one slot and the record
+//Record has to have 'AccountKey accNo' member and constructor from AccountKey, records can only be added (no erase)
+//records are kept in chunks of chunkSize shared by copies of the map, so copying the map copies only the table
+//and chunks' pointers, any non-const access to record copies its chunk first if other map still shares it and
+//points the chunk's slots to the copy (copy-on-write, shared chunks are never changed, so readers of the other map
+//aren't affected)
+template<typename Record>
+class FlatAccountMap
+{
+private:
+    //records in insertion order, non-const iterator copies shared chunks on access
+    template<typename Map, typename Value>
+    class Iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Value value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Value* pointer;
+        typedef Value& reference;
+
+        Iterator(Map* map, size_t index)
+            : map(map)
+            , index(index)
+        {}
+
+        reference operator*() const { return (*map)[index]; }
+        pointer operator->() const { return &(*map)[index]; }
+
+        Iterator& operator++() { ++index; return *this; }
+        Iterator operator++(int) { Iterator it(*this); ++index; return it; }
+
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+
+    private:
+        Map* map;
+        size_t index;
+    };
+
+public:
+    static const size_t chunkSize = 16;
+
+    typedef Iterator<FlatAccountMap, Record> iterator;
+    typedef Iterator<const FlatAccountMap, const Record> const_iterator;
+
+    FlatAccountMap()
+        : recordsCount(0)
+        , groupsMask(0)
+    {}
+
+    Record* find(const AccountKey& key)
+    {
+        if(recordsCount == 0) return nullptr;
+
+        size_t slot = findSlot(key, key.hash());
+
+        return (slot != notFound) ? &(*this)[indexes[slot]] : nullptr;
+    }
+
+    //[complexity: mostly O(1)]
+    const Record* find(const AccountKey& key) const
+    {
+        return find(key, key.hash());
+    }
+
+    //lookup with already calculated key's hash
+    const Record* find(const AccountKey& key, uint64_t hash) const
+    {
+        if(recordsCount == 0) return nullptr;
+
+        size_t slot = findSlot(key, hash);
+
+        return (slot != notFound) ? slots[slot] : nullptr;
+    }
+
+    //returning account's record, new one is created if there's no such account
+    Record& emplace(const AccountKey& key)
+    {
+        return (*this)[emplaceIndex(key)];
+    }
+
+    //position of account's record, new one is created if there's no such account
+    size_t emplaceIndex(const AccountKey& key)
+    {
+        uint64_t hash = key.hash();
+        size_t slot = (recordsCount == 0) ? notFound : findSlot(key, hash);
+
+        if(slot != notFound) return indexes[slot];
+
+        std::vector<Record>& chunk = appendableChunk();
+        chunk.emplace_back(key);
+        insertIndex(hash, &chunk.back(), static_cast<uint32_t>(recordsCount));
+
+        return recordsCount++;
+    }
+
+    //moving record of account which isn't in the map yet
+    Record& insert(Record&& newRecord)
+    {
+        std::vector<Record>& chunk = appendableChunk();
+        chunk.push_back(std::move(newRecord));
+        insertIndex(chunk.back().accNo.hash(), &chunk.back(), static_cast<uint32_t>(recordsCount));
+        ++recordsCount;
+
+        return chunk.back();
+    }
+
+    //hinting the processor to load key's first control group and its slots, so the following find doesn't wait for memory
+    void prefetch(uint64_t hash) const
+    {
+        if(control.empty()) return;
+
+        __builtin_prefetch(&control[groupOffset(hash)]);
+        __builtin_prefetch(&slots[groupOffset(hash)]);
+    }
+
+    //hinting the processor to load records matching hash in its first group, group should be prefetched earlier
+    //(batch lookups prefetch groups of all keys first, then records, so cache misses of all keys overlap)
+    void prefetchRecords(uint64_t hash) const
+    {
+        if(control.empty()) return;
+
+        const size_t offset = groupOffset(hash);
+        for(uint32_t match = matchGroup(&control[offset], controlHash(hash)); match != 0; match &= match - 1)
+            __builtin_prefetch(slots[offset + __builtin_ctz(match)]);
+    }
+
+    void reserve(size_t count)
+    {
+        chunks.reserve((count + chunkSize - 1) / chunkSize);
+        chunksRecords.reserve(chunks.capacity());
+
+        if(count > capacity() * maxLoadNum / maxLoadDen) rehash(count);
+    }
+
+    void clear()
+    {
+        chunks.clear();
+        chunksRecords.clear();
+        recordsCount = 0;
+        control.clear();
+        slots.clear();
+        indexes.clear();
+        groupsMask = 0;
+    }
+
+    //records are in insertion order, so they can be addressed by position, non-const access copies shared chunk
+    Record& operator[](size_t index)
+    {
+        makeChunkUnique(index / chunkSize);
+
+        return chunksRecords[index / chunkSize][index % chunkSize];
+    }
+
+    const Record& operator[](size_t index) const { return record(index); }
+
+    size_t size() const { return recordsCount; }
+    bool empty() const { return recordsCount == 0; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, recordsCount); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, recordsCount); }
+
+    //bytes used by table and records' chunks (without records' own allocations), chunks shared with other maps are included
+    size_t memoryUsage() const
+    {
+        return control.capacity() + slots.capacity() * sizeof(Record*) + indexes.capacity() * sizeof(uint32_t) + chunks.size() * chunkSize * sizeof(Record)
+            + chunks.capacity() * (sizeof(std::shared_ptr<std::vector<Record> >) + sizeof(Record*));
+    }
+
+private:
+    static const size_t groupSize = 16;
+    static const uint8_t emptyControl = 0x80;
+    static const size_t notFound = ~static_cast<size_t>(0);
+    static const size_t maxLoadNum = 7, maxLoadDen = 8;
+
+    std::vector<uint8_t> control;       //7 bits of hash for used slot or empty mark, aligned to groups
+    std::vector<Record*> slots;         //records of used slots, so lookup doesn't go through chunks
+    std::vector<uint32_t> indexes;      //positions of slots' records in insertion order
+    std::vector<std::shared_ptr<std::vector<Record> > > chunks;    //chunks have chunkSize capacity, so records never move
+    std::vector<Record*> chunksRecords; //records of chunks for access by position
+    size_t recordsCount;
+    size_t groupsMask;
+
+    size_t capacity() const { return slots.size(); }
+
+    const Record& record(size_t index) const { return chunksRecords[index / chunkSize][index % chunkSize]; }
+
+    //records already placed in chunks (the one being added included)
+    size_t storedCount() const { return chunks.empty() ? 0 : (chunks.size() - 1) * chunkSize + chunks.back()->size(); }
+
+    //copying chunk shared with other map, so it can be changed [complexity: O(chunkSize) records' copies]
+    void makeChunkUnique(size_t chunk)
+    {
+        if(chunks[chunk].use_count() == 1) return;
+
+        std::shared_ptr<std::vector<Record> > copy = std::make_shared<std::vector<Record> >();
+        copy->reserve(chunkSize);
+        copy->insert(copy->end(), chunks[chunk]->begin(), chunks[chunk]->end());
+
+        chunks[chunk] = copy;
+        chunksRecords[chunk] = copy->data();
+
+        for(Record& record : *copy)
+            slots[findSlot(record.accNo, record.accNo.hash())] = &record;
+    }
+
+    //chunk which the next record is added to, last chunk is copied if it's shared, new one is added if it's full
+    std::vector<Record>& appendableChunk()
+    {
+        if(recordsCount % chunkSize == 0)
+        {
+            chunks.push_back(std::make_shared<std::vector<Record> >());
+            chunks.back()->reserve(chunkSize);
+            chunksRecords.push_back(chunks.back()->data());
+        }
+        else
+        {
+            makeChunkUnique(chunks.size() - 1);
+        }
+
+        return *chunks.back();
+    }
+
+    static uint8_t controlHash(uint64_t hash) { return static_cast<uint8_t>(hash & 0x7f); }
+    size_t groupOffset(uint64_t hash) const { return ((hash >> 7) & groupsMask) * groupSize; }
+
+    //bit masks of slots in group with given control byte
+    static uint32_t matchGroup(const uint8_t* group, uint8_t val)
+    {
+#if defined(__SSE2__)
+        __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(val)))));
+#else
+        uint32_t mask = 0;
+        for(size_t i = 0; i < groupSize; ++i)
+            if(group[i] == val) mask |= (1u << i);
+        return mask;
+#endif
+    }
+
+    //probing groups in triangular sequence, which visits every group for power of two groups count
+    size_t findSlot(const AccountKey& key, uint64_t hash) const
+    {
+        const uint8_t h2 = controlHash(hash);
+        size_t group = (hash >> 7) & groupsMask;
+
+        for(size_t step = 1; ; ++step)
+        {
+            const uint8_t* groupControl = &control[group * groupSize];
+
+            for(uint32_t match = matchGroup(groupControl, h2); match != 0; match &= match - 1)
+            {
+                size_t slot = group * groupSize + __builtin_ctz(match);
+                if(slots[slot]->accNo == key) return slot;
+            }
+
+            if(matchGroup(groupControl, emptyControl) != 0) return notFound;
+
+            group = (group + step) & groupsMask;
+        }
+    }
+
+    void insertIndex(uint64_t hash, Record* newRecord, uint32_t index)
+    {
+        if(recordsCount + 1 > capacity() * maxLoadNum / maxLoadDen)
+        {
+            rehash(recordsCount + 1);           //new record is already in its chunk, so it's indexed by rehash
+            return;
+        }
+
+        placeIndex(hash, newRecord, index);
+    }
+
+    void placeIndex(uint64_t hash, Record* newRecord, uint32_t index)
+    {
+        size_t group = (hash >> 7) & groupsMask;
+
+        for(size_t step = 1; ; ++step)
+        {
+            uint32_t empty = matchGroup(&control[group * groupSize], emptyControl);
+
+            if(empty != 0)
+            {
+                size_t slot = group * groupSize + __builtin_ctz(empty);
+                control[slot] = controlHash(hash);
+                slots[slot] = newRecord;
+                indexes[slot] = index;
+                return;
+            }
+
+            group = (group + step) & groupsMask;
+        }
+    }
+
+    //rebuilding table for given records count, table size is power of two groups [complexity: O(n)]
+    void rehash(size_t count)
+    {
+        size_t groupsCount = 1;
+        while(groupsCount * groupSize * maxLoadNum / maxLoadDen < count * 2)
+            groupsCount *= 2;
+
+        control.assign(groupsCount * groupSize, emptyControl);
+        slots.assign(groupsCount * groupSize, nullptr);
+        indexes.assign(groupsCount * groupSize, 0);
+        groupsMask = groupsCount - 1;
+
+        for(size_t i = 0, count = storedCount(); i < count; ++i)
+            placeIndex(record(i).accNo.hash(), &chunksRecords[i / chunkSize][i % chunkSize], static_cast<uint32_t>(i));
+    }
+};
+
+template<typename Record> const size_t FlatAccountMap<Record>::chunkSize;
+template<typename Record> const size_t FlatAccountMap<Record>::groupSize;
+template<typename Record> const uint8_t FlatAccountMap<Record>::emptyControl;
+template<typename Record> const size_t FlatAccountMap<Record>::notFound;
+template<typename Record> const size_t FlatAccountMap<Record>::maxLoadNum;
+template<typename Record> const size_t FlatAccountMap<Record>::maxLoadDen;
+
+#endif //FLAT_ACCOUNT_MAP
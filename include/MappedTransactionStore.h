@@ -0,0 +1,55 @@
+#ifndef MAPPED_TRANSACTION_STORE
+#define MAPPED_TRANSACTION_STORE
+
+#include <string>
+#include <vector>
+#include "Database.h"
+#include "TransactionStoreExceptions.h"
+#include "TransactionsView.h"
+#include "SnapshotFile.h"
+
+//read-only store serving queries straight from mmapped snapshot file (written by TransactionStore::saveSnapshot)
+//opening doesn't parse nor copy data, it reads only accounts' entries and index to validate them,
+//transactions' pages are loaded by the OS on first access
+class MappedTransactionStore: public Database
+{
+public:
+    //verifyData checks whole file's checksum, which reads all of it, by default only the header and the values
+    //lookups depend on (index slots and accounts' ranges of transactions) are verified
+    explicit MappedTransactionStore(const std::string& path, bool verifyData = false);
+    ~MappedTransactionStore();
+
+    MappedTransactionStore(const MappedTransactionStore&) = delete;
+    MappedTransactionStore& operator=(const MappedTransactionStore&) = delete;
+
+    Transaction findTransaction(const std::string &accNo, int txNo) override;
+    std::vector<Transaction> findTransactions(const std::string &accNo) override;
+    double calculateAverageAmount(const std::string &accNo) override;
+
+    //snapshot can't be modified, always throws SnapshotFileException
+    void setTransactions(const std::vector<Transaction> &transactions) override;
+
+    //view is valid as long as the store exists
+    TransactionsView findTransactionsView(const std::string &accNo) const;
+
+    size_t accountsCount() const { return header->accountsCount; }
+    size_t transactionsCount() const { return header->transactionsCount; }
+
+private:
+    std::string path;
+    void* mapping;
+    size_t mappingSize;
+
+    const SnapshotFileHeader* header;
+    const SnapshotAccountEntry* entries;
+    const SnapshotIndexSlot* index;
+    const unsigned int* txNos;
+    const double* amounts;
+
+    void verifyHeader(size_t fileSize) const;
+    void verifyAccounts() const;
+    void unmap();
+    const SnapshotAccountEntry& getAccount(const std::string& accNo) const;
+};
+
+#endif //MAPPED_TRANSACTION_STORE
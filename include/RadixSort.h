@@ -0,0 +1,25 @@
+#ifndef RADIX_SORT
+#define RADIX_SORT
+
+#include <cstddef>
+#include <vector>
+
+//stable LSD radix sort of account's rows by txNo, txNos and amounts columns are permuted together
+//one pass over the rows counts all four 8 bits digits, then rows are scattered once per digit which isn't the same
+//in all rows (so txNos from a narrow range take only 2-3 passes), small groups are sorted by insertion
+class TxNoRadixSorter
+{
+public:
+    static const size_t minRadixCount = 64;        //smaller groups are sorted by insertion
+
+    //sorting count rows in place, buffers are kept between calls [complexity: O(n), O(n^2) for small groups]
+    void sort(unsigned int* txNos, double* amounts, size_t count);
+
+private:
+    std::vector<unsigned int> txNosBuffer;
+    std::vector<double> amountsBuffer;
+
+    static void insertionSort(unsigned int* txNos, double* amounts, size_t count);
+};
+
+#endif //RADIX_SORT
@@ -0,0 +1,51 @@
+#ifndef SNAPSHOT_FILE
+#define SNAPSHOT_FILE
+
+#include <cstdint>
+#include <string>
+#include "AccountKey.h"
+
+//binary snapshot of loaded store, file is used directly after mmap (see MappedTransactionStore)
+//layout: header | accounts entries | index slots | txNos column | amounts column
+//all sections are 64 bytes aligned, numbers are in native (little endian) byte order
+const char snapshotMagic[8] = { 'T', 'X', 'S', 'T', 'O', 'R', 'E', 0 };
+const uint32_t snapshotVersion = 1;
+
+struct SnapshotFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fileSize;
+    uint64_t accountsCount;
+    uint64_t transactionsCount;
+    uint64_t indexCapacity;             //power of two slots of open addressing index
+    uint64_t accountsOffset;
+    uint64_t indexOffset;
+    uint64_t txNosOffset;
+    uint64_t amountsOffset;
+    uint64_t dataChecksum;              //checksum of everything after the header
+    uint64_t headerChecksum;            //checksum of header's fields above
+};
+
+//account with its precomputed average, transactions are a range of the columns sorted by txNo
+struct SnapshotAccountEntry
+{
+    AccountKey accNo;
+    uint64_t firstTransaction;
+    uint64_t transactionsCount;
+    double averageAmount;
+};
+
+//index slot keeps account's entry number + 1 (0 marks empty slot), slots are probed linearly from key's hash
+typedef uint32_t SnapshotIndexSlot;
+
+struct StoreSnapshot;
+
+//writing store's data to file, file is written under temporary name and renamed, so it's never seen incomplete
+void writeSnapshotFile(const StoreSnapshot& snapshot, const std::string& path);
+
+//64 bit checksum of data processed in four independent lanes of 8 byte words
+uint64_t snapshotChecksum(const void* data, size_t size);
+
+#endif //SNAPSHOT_FILE
@@ -0,0 +1,64 @@
+#ifndef TRANSACTION_SEARCH_INDEX
+#define TRANSACTION_SEARCH_INDEX
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ColumnArena.h"
+
+//search index over account's sorted txNo column, kind of search is chosen per account when index is built:
+// - binary search for small accounts, whose column takes only a few cache lines
+// - interpolation when txNos are close to uniform, position is predicted from txNo and only a window
+//   of maxError elements around it is searched (error is measured for all txNos, so search is always exact)
+// - otherwise every blockSize-th txNo is kept in Eytzinger (BFS) layout of perfect binary tree, which is searched
+//   with prefetching of next levels, and only one block (one cache line) of the column is read
+class TransactionSearchIndex
+{
+public:
+    enum class Kind: uint8_t
+    {
+        Binary,
+        Interpolation,
+        Eytzinger
+    };
+
+    static const size_t binarySearchLimit = 1024;      //accounts with fewer transactions use binary search
+    static const size_t maxInterpolationError = 32;    //interpolation is used if all txNos are within the error
+    static const size_t blockSize = 16;                //txNos in one 64 bytes block of the column
+
+    TransactionSearchIndex()
+        : kind(Kind::Binary)
+        , maxError(0)
+        , blocksCount(0)
+        , treeHeight(0)
+    {}
+
+    //building index for sorted txNos without duplicates, has to be rebuilt after the column is changed,
+    //separators are allocated in arena if it's given [complexity: O(n)]
+    void build(const unsigned int* txNos, size_t count, ColumnArena* arena = nullptr);
+
+    //position of txNo in the column which index was built for, count if there's no such txNo
+    //[complexity: O(log(n)), O(log(maxError)) for interpolation]
+    size_t find(const unsigned int* txNos, size_t count, unsigned int txNo) const;
+
+    //hinting the processor to load the first memory which find will read
+    void prefetch(const unsigned int* txNos, size_t count, unsigned int txNo) const;
+
+    Kind getKind() const { return kind; }
+    size_t memoryUsage() const { return separators.capacity() * sizeof(unsigned int); }
+
+private:
+    Kind kind;
+    uint32_t maxError;
+    ArenaVector<unsigned int> separators;       //first txNos of the blocks in Eytzinger order, 1-based, padded with max
+    size_t blocksCount;
+    unsigned int treeHeight;
+
+    size_t findInterpolation(const unsigned int* txNos, size_t count, unsigned int txNo) const;
+    size_t findEytzinger(const unsigned int* txNos, size_t count, unsigned int txNo) const;
+
+    static size_t predictPosition(const unsigned int* txNos, size_t count, unsigned int txNo);
+    void fillEytzinger(const unsigned int* txNos, size_t& block, size_t node);
+};
+
+#endif //TRANSACTION_SEARCH_INDEX
@@ -7,45 +7,339 @@
 #include <algorithm>
 #include <exception>
 #include <limits>
+#include <thread>
+#include <functional>
+#include <atomic>
+#include <mutex>
 #include "Database.h"
 #include "TransactionStoreExceptions.h"
+#include "TransactionsView.h"
+#include "AmountAggregate.h"
+#include "AccountNumberValidator.h"
+#include "AccountKey.h"
+#include "FlatAccountMap.h"
+#include "EpochReclamation.h"
+#include "CsvTransactionsReader.h"
+#include "BlockedBloomFilter.h"
+#include "TransactionSearchIndex.h"
+#include "AmountRangeTree.h"
+#include "AmountPrefixSums.h"
+#include "FixedPointAmounts.h"
+#include "ColumnArena.h"
+#include "RadixSort.h"
+#include "AccountStats.h"
+#include "AmountHistogram.h"
 
+//account's transactions kept in columns, account number is stored only once
 struct AccountTransactions
 {
-    std::string accNo;
-    std::vector<Transaction> transactions;
-    double averageAmount;
+    AccountKey accNo;
+    TxNoColumn txNos;                       //columns and indexes are in snapshot's arena if it's enabled, otherwise on heap
+    AmountColumn amounts;
+    AmountAggregate amountAggregate;
+    AccountStats stats;                     //updated with aggregate, average of the whole account is kept here
+    TransactionSearchIndex searchIndex;     //indexes have to be rebuilt whenever columns change
+    AmountRangeTree amountRangeTree;
+    AmountPrefixSums amountPrefixSums;
+    CentsColumn cents;                      //amounts in cents, only in fixed-point mode
+    CentsPrefixSums centsPrefixSums;
 
-    AccountTransactions(const std::string& accNo)
+    AccountTransactions(const AccountKey& accNo)
         : accNo(accNo)
-        , averageAmount(0.0)
+        , stats()
     {}
 };
 
+//all data of the store, snapshot isn't changed after it's published (unless concurrent reads are disabled)
+struct StoreSnapshot
+{
+    typedef FlatAccountMap<AccountTransactions> AccountsMap;
+
+    std::vector<std::shared_ptr<ColumnArena> > columnArenas;   //released after accounts, whose columns can be there
+    AccountsMap accounts;
+
+    //optional filters of account keys and (accNo, txNo) pairs, misses are rejected without touching accounts
+    BlockedBloomFilter accountsFilter;
+    BlockedBloomFilter transactionsFilter;
+
+    bool fixedPointAmounts;                 //accounts have cents columns, appended amounts have to be convertible too
+
+    StoreSnapshot()
+        : fixedPointAmounts(false)
+    {}
+
+    //copy shares chunks of accounts, pages of filters and arenas holding their columns with the original,
+    //changed chunks and pages are cloned on write, cloned columns are allocated on heap [complexity: O(accounts / 16)]
+    StoreSnapshot(const StoreSnapshot& other)
+        : columnArenas(other.columnArenas)
+        , accounts(other.accounts)
+        , accountsFilter(other.accountsFilter)
+        , transactionsFilter(other.transactionsFilter)
+        , fixedPointAmounts(other.fixedPointAmounts)
+    {}
+};
+
+struct StoreStats
+{
+    size_t accountsCount;
+    size_t transactionsCount;
+    size_t memoryUsage;         //approximated number of bytes used by the store's data (with filters)
+    size_t filtersMemoryUsage;  //bytes used by lookup filters
+};
+
+//result of single lookup in batch, batch lookups don't throw for missing accounts or transactions
+enum class LookupStatus: uint8_t
+{
+    Found,
+    AccountNotFound,            //also for invalid account number
+    TransactionNotFound
+};
+
+//grouping and sorting of loaded transactions
+enum class LoadAlgorithm: uint8_t
+{
+    ComparisonSort,             //rows are appended to growing account's columns, which are stable sorted
+    RadixPartition              //rows are counted per account and scattered to exactly sized columns, which are radix sorted
+};
+
+struct TransactionQuery
+{
+    std::string accNo;
+    int txNo;
+};
+
+struct TransactionLookup
+{
+    LookupStatus status;
+    Transaction transaction;    //set only if found
+};
+
+struct AverageLookup
+{
+    LookupStatus status;
+    double averageAmount;       //set only if found
+};
+
+struct AccountStatsLookup
+{
+    LookupStatus status;
+    AccountStats stats;         //set only if found
+};
+
+struct TransactionsLookup
+{
+    LookupStatus status;
+    TransactionsView transactions;  //empty if account isn't found
+};
+
+//aggregate of amounts of account's transactions with txNo in some range
+//for empty range count and sum are 0, average, minAmount and maxAmount are NaN
+struct AmountRangeAggregate
+{
+    size_t count;
+    double sum;             //can be infinite if the exact sum is beyond double's range, average is always finite
+    double average;
+    double minAmount;
+    double maxAmount;
+};
+
+//aggregate of amounts of all accounts' transactions
+//for empty store sum and average are 0, minAmount and maxAmount are NaN
+struct GlobalAggregate
+{
+    size_t accountsCount;
+    size_t transactionsCount;
+    double sum;             //can be infinite if the exact sum is beyond double's range, average is always finite
+    double average;
+    double minAmount;
+    double maxAmount;
+};
+
+//order of accounts returned by findTopAccounts, accounts with equal values are ordered by account number
+enum class AccountRanking: uint8_t
+{
+    TransactionsCount,
+    TotalAmount,
+    AverageAmount
+};
+
+struct RankedAccount
+{
+    std::string accNo;
+    AccountStats stats;
+};
+
 class TransactionStore: public Database
 {
 public:
+    explicit TransactionStore(unsigned int threadsCount = 1);
+
+    TransactionStore(const TransactionStore&) = delete;
+    TransactionStore& operator=(const TransactionStore&) = delete;
+
     Transaction findTransaction(const std::string &accNo, int txNo) override;
     std::vector<Transaction> findTransactions(const std::string &accNo) override;
     double calculateAverageAmount(const std::string &accNo) override;
+
+    //zero-copy version of findTransactions, view is valid until the next setTransactions or appendTransactions call
+    TransactionsView findTransactionsView(const std::string &accNo);
+
+    //without concurrent reads loaded data is released before loading, so old and new data aren't in memory together
+    //and loading which throws (invalid account number or amount) leaves the store empty, with concurrent reads
+    //new data is built aside and loading which throws leaves previously loaded data unchanged
     void setTransactions(const std::vector<Transaction> &transactions) override;
 
+    //consuming version of setTransactions, vector is moved into the store and released right after its rows are loaded
+    //(before sorting and building indexes), so peak memory doesn't hold input with all loaded data
+    void setTransactions(std::vector<Transaction> &&transactions);
+
+    //loading "accNo,txNo,amount" lines (see CsvTransactionsReader), replaces loaded data like setTransactions
+    //rows are parsed chunk by chunk straight into accounts' columns, no std::vector<Transaction> is built
+    //file which can't be opened or read throws std::system_error with errno, malformed line TransactionsFormatException
+    //failure leaves the store like failed setTransactions (empty without concurrent reads), except for file which
+    //can't be opened, which leaves loaded data unchanged
+    void loadTransactionsFromFile(const std::string& path);
+    void loadTransactionsFromDescriptor(int fd);
+
+    //adding transactions to the loaded ones without reloading, already loaded (accNo, txNo) win over appended duplicates
+    void appendTransactions(const std::vector<Transaction> &transactions);
+
+    //non-throwing versions of queries, misses are reported by status, which is much cheaper than exception
+    //(Database's methods are wrappers throwing AccountException or TransactionException for not found status)
+    TransactionLookup tryFindTransaction(const std::string &accNo, int txNo);
+    TransactionsLookup tryFindTransactionsView(const std::string &accNo);
+    AverageLookup tryCalculateAverageAmount(const std::string &accNo);
+
+    //batch versions of findTransaction and calculateAverageAmount, results are in queries' order
+    //lookups are resolved in blocks with all keys' memory prefetched first, so their cache misses overlap
+    std::vector<TransactionLookup> findTransactionBatch(const std::vector<TransactionQuery>& queries);
+    std::vector<AverageLookup> calculateAverageAmountBatch(const std::vector<std::string>& accNos);
+
+    //transactions with txNo in [loTx, hiTx), view of the part of account's transactions, nothing is copied
+    TransactionsView findTransactionsInRange(const std::string &accNo, unsigned int loTx, unsigned int hiTx);
+
+    //count, sum, average, min and max of amounts of transactions with txNo in [loTx, hiTx) [complexity: O(log(n))]
+    AmountRangeAggregate calculateRangeAggregate(const std::string &accNo, unsigned int loTx, unsigned int hiTx);
+
+    //average amount of transactions with txNo in [loTx, hiTx), 0 if there's none
+    //[complexity: O(log(n)) search of range's bounds, difference of prefix sums with at most two partial blocks]
+    double calculateAverageAmount(const std::string &accNo, unsigned int loTx, unsigned int hiTx);
+    AverageLookup tryCalculateAverageAmount(const std::string &accNo, unsigned int loTx, unsigned int hiTx);
+
+    //count, sum, average, min, max, variance and standard deviation of all account's amounts
+    //statistics are precomputed while loading and appending [complexity: O(1), single hash lookup]
+    AccountStats getAccountStats(const std::string &accNo);
+    AccountStatsLookup tryGetAccountStats(const std::string &accNo);
+
+    //store-wide queries scanning all accounts of one snapshot (consistent even if other thread loads transactions)
+    //accounts are split into blocks, which threads (see setThreadsCount) take one by one
+
+    //count, sum, average, min and max of all amounts, merged from accounts' aggregates
+    //[complexity: O(accounts), O(n) sum of cents in fixed-point mode]
+    GlobalAggregate calculateGlobalAggregate();
+
+    //k best accounts by ranking (biggest values first), ranked by accounts' statistics [complexity: O(accounts * log(k))]
+    std::vector<RankedAccount> findTopAccounts(size_t k, AccountRanking ranking);
+
+    //histogram of all amounts in bucketsCount equal buckets of [minAmount, maxAmount), full scan of amounts columns
+    //throws std::invalid_argument for no buckets or empty range [complexity: O(n)]
+    AmountHistogram calculateAmountHistogram(double minAmount, double maxAmount, size_t bucketsCount);
+
+    StoreStats getStats() const;
+
+    //writing loaded data to binary snapshot file, which can be opened instantly by MappedTransactionStore
+    void saveSnapshot(const std::string& path) const;
+
+    //number of threads used for loading transactions, 0 means hardware concurrency
+    void setThreadsCount(unsigned int count);
+    unsigned int getThreadsCount() const { return threadsCount; }
+
+    //lookup filters rejecting most of not existing accounts and transactions, rate is filters' false positive rate
+    //0 disables filters, new rate is used from the next setTransactions or load [memory: ~1.2 byte per transaction for 1%]
+    void setFilterFalsePositiveRate(double rate);
+    double getFilterFalsePositiveRate() const { return filterFalsePositiveRate; }
+
+    //fixed-point mode keeps amounts also as integer cents, averages and range sums are calculated from exact 128-bit sums
+    //(doubles are still returned by queries and views), mode is used from the next setTransactions or load
+    //amounts have to have at most two decimal digits and be below 2^46, otherwise loading throws AmountException
+    //[memory: 8 bytes per transaction]
+    void setFixedPointAmounts(bool enabled);
+    bool getFixedPointAmounts() const { return fixedPointAmounts; }
+
+    //setTransactions counts transactions of all accounts first and carves their columns from one slab of exact size
+    //(no reallocations while loading, no per-account frees, whole slab is released with replaced data), cents columns
+    //and accounts' indexes (search separators, range trees, prefix sums) are carved from the following slabs
+    //appended transactions and loading from file use heap, mode is used from the next setTransactions
+    void setArenaColumns(bool enabled);
+    bool getArenaColumns() const { return arenaColumns; }
+
+    //algorithm used by setTransactions and appending (loading from file only sorts with it), radix partitioning is O(n)
+    //and avoids reallocations of columns, with many threads every thread handles its own partition of accounts
+    void setLoadAlgorithm(LoadAlgorithm algorithm);
+    LoadAlgorithm getLoadAlgorithm() const { return loadAlgorithm; }
+
+    //in concurrent mode queries can be called from many threads while other thread loads transactions
+    //queries read published snapshot without locks, loading builds new snapshot aside and swaps it atomically
+    //(appending shares unchanged chunks and clones only the chunks the batch touches), old snapshot is deleted
+    //when no query reads it anymore
+    void setConcurrentReads(bool enabled);
+    bool getConcurrentReads() const { return concurrentReads; }
+
+    //keeps data read from the store (e.g. views) valid while other threads load transactions
+    //thread holding the guard can't load transactions itself
+    typedef EpochDomain::ReadGuard ReadGuard;
+
 private:
-    typedef std::unordered_map<std::string, std::unique_ptr<AccountTransactions> > AccountsMap;
-    AccountsMap accounts;
+    typedef StoreSnapshot::AccountsMap AccountsMap;
+    std::unique_ptr<StoreSnapshot> ownedSnapshot;   //owner of published snapshot, changed only under writeMutex
+    std::atomic<StoreSnapshot*> snapshot;           //published snapshot read by queries without locks
+    mutable std::mutex writeMutex;
+    std::atomic<unsigned int> threadsCount;        //read by store-wide queries without locks
+    bool concurrentReads;
+    double filterFalsePositiveRate;
+    bool fixedPointAmounts;
+    bool arenaColumns;
+    LoadAlgorithm loadAlgorithm;
+
+    const StoreSnapshot& currentSnapshot() const { return *(snapshot.load(std::memory_order_acquire)); }
+    void publishSnapshot(std::unique_ptr<StoreSnapshot> newSnapshot);
+    void replaceSnapshot(const std::function<void(StoreSnapshot&)>& load);
+    ColumnArena* createColumnArena(StoreSnapshot& target) const;
+
+    const AccountTransactions* findAccount(const std::string& accNo) const;
+    static const AccountTransactions* findAccount(const StoreSnapshot& snapshot, const AccountKey& key, uint64_t hash);
+    static size_t findTransactionIndex(const AccountTransactions& account, unsigned int txNo);
+    static std::pair<size_t, size_t> findTransactionsRange(const AccountTransactions& account, unsigned int loTx, unsigned int hiTx);
+    void findAccountsBlock(const std::string* const* accNos, size_t count, const AccountTransactions** accounts) const;
+
+    void loadAccountsTransactionData(const std::vector<Transaction> &transactions, AccountsMap& accountsMap, ColumnArena* arena);
+    void loadAccountsTransactionData(CsvTransactionsReader& reader, AccountsMap& accountsMap);
+    void checkAccountNumber(const std::string& accNo);
+    void addTransactionToAccount(const AccountKey& key, unsigned int txNo, double amount, AccountsMap& accountsMap);
+    static void reserveExactColumns(AccountsMap& accountsMap, const std::vector<uint32_t>& recordIndexes, ColumnArena* arena);
+
+    void loadTransactions(const std::vector<Transaction> &transactions, std::vector<Transaction>* consumed);
+    void loadTransactionsParallel(const std::vector<Transaction> &transactions, StoreSnapshot& target, std::vector<Transaction>* consumed);
+    void runInThreads(unsigned int count, const std::function<void(unsigned int)>& func);
+    void scanAccountsInThreads(unsigned int count, size_t accountsCount, const std::function<void(unsigned int, size_t, size_t)>& func);
+    void mergeAccountsShards(std::vector<AccountsMap>& shards, AccountsMap& accountsMap);
 
-    AccountsMap::iterator getAccount(const std::string& accNo);
-    std::vector<Transaction>::iterator transactionBinarySearch(const AccountsMap::iterator& accountIt, unsigned int txNo);
+    void buildFilters(StoreSnapshot& snapshot, size_t growth) const;
+    void addToFilters(const AccountTransactions& account, StoreSnapshot& snapshot) const;
+    void addToFilters(uint64_t accountHash, unsigned int txNo, StoreSnapshot& snapshot) const;
 
-    void loadAccountsTransactionData(const std::vector<Transaction> &transactions);
-    void checkAccountNumber(std::string accNo);
-    void addTransactionToAccount(const Transaction& transaction, AccountsMap::iterator& accounIt);
-    AccountsMap::iterator createAccount(const std::string& accNo);
-    bool isTransactionDuplicate(const Transaction& transaction, const AccountsMap::iterator& accountIt);
+    void processAccountsData(AccountsMap& accountsMap);
+    void sortTransactionsData(AccountsMap& accountsMap);
+    void removeDuplicatedTransactions(AccountsMap& accountsMap);
+    void calculateAveragesOfTransactions(AccountsMap& accountsMap);
+    void buildAccountsIndexes(AccountsMap& accountsMap);
+    static void buildAccountIndexes(AccountTransactions& account);
+    void calculateAccountAggregate(AccountTransactions& account);
+    static void updateAccountStats(AccountTransactions& account);
+    void convertAccountsAmounts(AccountsMap& accountsMap);
+    static void convertAccountAmounts(AccountTransactions& account);
 
-    void sortTransactionsData();
-    void calculateAveragesOfTransactions();
-    double calculateAccountAverage(const AccountsMap::iterator& accountIt);
+    void mergeAccountTransactions(AccountTransactions& account, const AccountTransactions& batch, StoreSnapshot& target) const;
 };
 
 
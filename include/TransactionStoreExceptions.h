@@ -2,6 +2,7 @@
 #define TRANSACTION_STORE_EXCEPTIONS
 
 #include <exception>
+#include <cstddef>
 #include <string>
 
 struct AccountException: public std::exception
@@ -21,4 +22,39 @@ struct TransactionException: public std::exception
     {}
 };
 
+//amount which can't be stored in fixed-point mode (more than two decimal digits or too big)
+struct AmountException: public std::exception
+{
+    std::string accNo;
+    double amount;
+    AmountException(const std::string& accNo, double amount)
+        : accNo(accNo)
+        , amount(amount)
+    {}
+};
+
+struct SnapshotFileException: public std::exception
+{
+    std::string path;
+    std::string reason;
+    SnapshotFileException(const std::string& path, const std::string& reason)
+        : path(path)
+        , reason(reason)
+    {}
+
+    const char* what() const noexcept override { return reason.c_str(); }
+};
+
+struct TransactionsFormatException: public std::exception
+{
+    size_t line;
+    std::string reason;
+    TransactionsFormatException(size_t line, const std::string& reason)
+        : line(line)
+        , reason(reason)
+    {}
+
+    const char* what() const noexcept override { return reason.c_str(); }
+};
+
 #endif //TRANSACTION_STORE_EXCEPTIONS
@@ -0,0 +1,122 @@
+#ifndef TRANSACTIONS_VIEW
+#define TRANSACTIONS_VIEW
+
+#include <string>
+#include <iterator>
+#include "Database.h"
+#include "AccountKey.h"
+
+//single transaction read from the store's columns, account number is shared by all account's transactions
+struct TransactionRef
+{
+    const AccountKey& accNo;
+    unsigned int txNo;
+    double amount;
+
+    operator Transaction() const { return Transaction{ accNo.toString(), txNo, amount }; }
+};
+
+//read-only view of account's transactions sorted by txNo without duplicates, nothing is copied
+//view points to the store's data, so it's valid only until the next setTransactions or appendTransactions call on that store
+class TransactionsView
+{
+public:
+    //iterator keeps the view's columns, so it stays valid when the view is copied or destroyed (while store's data is)
+    class const_iterator
+    {
+    public:
+        //arrow operator returns transaction by value, so pointer is proxy holding it
+        class pointer
+        {
+        public:
+            explicit pointer(const TransactionRef& ref)
+                : ref(ref)
+            {}
+
+            const TransactionRef* operator->() const { return &ref; }
+
+        private:
+            TransactionRef ref;
+        };
+
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef TransactionRef value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef TransactionRef reference;
+
+        const_iterator(const AccountKey* accNo, const unsigned int* txNos, const double* amounts, size_t index)
+            : accNo(accNo)
+            , txNos(txNos)
+            , amounts(amounts)
+            , index(index)
+        {}
+
+        TransactionRef operator*() const { return TransactionRef{ *accNo, txNos[index], amounts[index] }; }
+        pointer operator->() const { return pointer(**this); }
+        TransactionRef operator[](difference_type offset) const { return *(*this + offset); }
+
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator it(*this); ++index; return it; }
+        const_iterator& operator--() { --index; return *this; }
+        const_iterator operator--(int) { const_iterator it(*this); --index; return it; }
+        const_iterator& operator+=(difference_type offset) { index += offset; return *this; }
+        const_iterator& operator-=(difference_type offset) { index -= offset; return *this; }
+        const_iterator operator+(difference_type offset) const { return const_iterator(accNo, txNos, amounts, index + offset); }
+        const_iterator operator-(difference_type offset) const { return const_iterator(accNo, txNos, amounts, index - offset); }
+        friend const_iterator operator+(difference_type offset, const const_iterator& it) { return it + offset; }
+        difference_type operator-(const const_iterator& other) const { return static_cast<difference_type>(index) - static_cast<difference_type>(other.index); }
+
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator<(const const_iterator& other) const { return index < other.index; }
+        bool operator>(const const_iterator& other) const { return index > other.index; }
+        bool operator<=(const const_iterator& other) const { return index <= other.index; }
+        bool operator>=(const const_iterator& other) const { return index >= other.index; }
+
+    private:
+        const AccountKey* accNo;
+        const unsigned int* txNos;
+        const double* amounts;
+        size_t index;
+    };
+
+    //empty view without account, returned by lookups which haven't found the account
+    TransactionsView()
+        : accNo(&emptyAccountNumber())
+        , txNoColumn(nullptr)
+        , amountColumn(nullptr)
+        , count(0)
+    {}
+
+    TransactionsView(const AccountKey& accNo, const unsigned int* txNos, const double* amounts, size_t count)
+        : accNo(&accNo)
+        , txNoColumn(txNos)
+        , amountColumn(amounts)
+        , count(count)
+    {}
+
+    const_iterator begin() const { return const_iterator(accNo, txNoColumn, amountColumn, 0); }
+    const_iterator end() const { return const_iterator(accNo, txNoColumn, amountColumn, count); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    TransactionRef operator[](size_t index) const { return TransactionRef{ *accNo, txNoColumn[index], amountColumn[index] }; }
+    TransactionRef front() const { return (*this)[0]; }
+    TransactionRef back() const { return (*this)[count - 1]; }
+
+    //direct access to the account's columns
+    const AccountKey& accountNumber() const { return *accNo; }
+    const unsigned int* txNos() const { return txNoColumn; }
+    const double* amounts() const { return amountColumn; }
+
+private:
+    static const AccountKey& emptyAccountNumber() { static const AccountKey key; return key; }
+
+    const AccountKey* accNo;
+    const unsigned int* txNoColumn;
+    const double* amountColumn;
+    size_t count;
+};
+
+#endif //TRANSACTIONS_VIEW
@@ -0,0 +1,109 @@
+#include <cstring>
+#include "AccountNumberValidator.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ACCOUNT_VALIDATOR_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    typedef bool (*ValidatorFunc)(const char*, size_t);
+
+    //mask of bits for first length characters
+    unsigned int charactersMask(size_t length)
+    {
+        return (length == maxAccountNumberLength) ? 0xffffffffu : ((1u << length) - 1u);
+    }
+
+#ifdef ACCOUNT_VALIDATOR_X86
+    //mask of alphanum characters in 16 bytes, bytes are signed so all non-ascii ones are below '0'
+    inline __m128i alphanumMask16(__m128i chars)
+    {
+        __m128i digits = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+
+        //setting 0x20 bit maps capital letters to normal ones
+        __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+        __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+
+        return _mm_or_si128(digits, letters);
+    }
+
+    bool isAccountNumberValidSse2(const char* accNo, size_t length)
+    {
+        alignas(16) char buffer[maxAccountNumberLength] = {};
+        std::memcpy(buffer, accNo, length);
+
+        unsigned int low = static_cast<unsigned int>(_mm_movemask_epi8(alphanumMask16(_mm_load_si128(reinterpret_cast<const __m128i*>(buffer)))));
+        unsigned int high = static_cast<unsigned int>(_mm_movemask_epi8(alphanumMask16(_mm_load_si128(reinterpret_cast<const __m128i*>(buffer + 16)))));
+
+        unsigned int mask = charactersMask(length);
+
+        return ((low | (high << 16)) & mask) == mask;
+    }
+
+    __attribute__((target("avx2")))
+    bool isAccountNumberValidAvx2(const char* accNo, size_t length)
+    {
+        alignas(32) char buffer[maxAccountNumberLength] = {};
+        std::memcpy(buffer, accNo, length);
+
+        __m256i chars = _mm256_load_si256(reinterpret_cast<const __m256i*>(buffer));
+
+        __m256i digits = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chars));
+
+        __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+        __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+
+        unsigned int valid = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_or_si256(digits, letters)));
+        unsigned int mask = charactersMask(length);
+
+        return (valid & mask) == mask;
+    }
+#endif
+
+    ValidatorFunc chooseValidator()
+    {
+#ifdef ACCOUNT_VALIDATOR_X86
+        if(__builtin_cpu_supports("avx2")) return isAccountNumberValidAvx2;
+        if(__builtin_cpu_supports("sse2")) return isAccountNumberValidSse2;
+#endif
+        return isAccountNumberValidScalar;
+    }
+
+    const ValidatorFunc validator = chooseValidator();
+}
+
+bool isAccountNumberValid(const char* accNo, size_t length)
+{
+    if(length > maxAccountNumberLength || length == 0) return false;
+
+    return validator(accNo, length);
+}
+
+bool isAccountNumberValidScalar(const char* accNo, size_t length)
+{
+    if(length > maxAccountNumberLength || length == 0) return false;
+
+    for(size_t i = 0; i < length; ++i)
+    {
+        char l = accNo[i];
+
+        if(!((l >= '0' && l <= '9') || (l >= 'A' && l <= 'Z') || (l >= 'a' && l <= 'z'))) return false;
+    }
+
+    return true;
+}
+
+//[complexity: O(n)]
+std::vector<size_t> findInvalidAccountNumbers(const std::vector<Transaction>& transactions)
+{
+    std::vector<size_t> invalidIndexes;
+
+    for(size_t i = 0; i < transactions.size(); ++i)
+    {
+        if(!isAccountNumberValid(transactions[i].accNo)) invalidIndexes.push_back(i);
+    }
+
+    return invalidIndexes;
+}
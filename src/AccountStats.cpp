@@ -0,0 +1,66 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "AccountStats.h"
+
+namespace
+{
+    const size_t lanesCount = 4;        //independent accumulators, so the loop can be vectorized
+}
+
+AccountStats calculateAccountStats(const double* amounts, size_t count, double maxAbs, double sum, double average)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    AccountStats stats = { count, sum, average, nan, nan, 0.0, 0.0 };
+
+    if(count == 0) return stats;
+
+    //scaled amounts and average are below 2 in absolute value, scaling by power of two is exact
+    const int exponent = (maxAbs > 0.0) ? std::ilogb(maxAbs) : 0;
+    const double scale = std::ldexp(1.0, -exponent), scaledAverage = average * scale;
+
+    double lanesMin[lanesCount], lanesMax[lanesCount];
+    double lanesDeviation[lanesCount] = {}, lanesSquares[lanesCount] = {};
+    std::fill(lanesMin, lanesMin + lanesCount, amounts[0]);
+    std::fill(lanesMax, lanesMax + lanesCount, amounts[0]);
+
+    size_t i = 0;
+    for(; i + lanesCount <= count; i += lanesCount)
+    {
+        for(size_t lane = 0; lane < lanesCount; ++lane)
+        {
+            const double amount = amounts[i + lane], deviation = amount * scale - scaledAverage;
+            lanesMin[lane] = std::min(lanesMin[lane], amount);
+            lanesMax[lane] = std::max(lanesMax[lane], amount);
+            lanesDeviation[lane] += deviation;
+            lanesSquares[lane] += deviation * deviation;
+        }
+    }
+
+    for(; i < count; ++i)
+    {
+        const double amount = amounts[i], deviation = amount * scale - scaledAverage;
+        lanesMin[0] = std::min(lanesMin[0], amount);
+        lanesMax[0] = std::max(lanesMax[0], amount);
+        lanesDeviation[0] += deviation;
+        lanesSquares[0] += deviation * deviation;
+    }
+
+    double deviationSum = 0.0, squaresSum = 0.0;
+    for(size_t lane = 0; lane < lanesCount; ++lane)
+    {
+        stats.minAmount = (lane == 0) ? lanesMin[0] : std::min(stats.minAmount, lanesMin[lane]);
+        stats.maxAmount = (lane == 0) ? lanesMax[0] : std::max(stats.maxAmount, lanesMax[lane]);
+        deviationSum += lanesDeviation[lane];
+        squaresSum += lanesSquares[lane];
+    }
+
+    //sum of deviations is 0 for exact average, subtracting its square corrects rounding of the average
+    const double n = static_cast<double>(count);
+    const double scaledVariance = std::max(0.0, (squaresSum - deviationSum * deviationSum / n) / n);
+
+    stats.variance = std::ldexp(scaledVariance, 2 * exponent);
+    stats.standardDeviation = std::ldexp(std::sqrt(scaledVariance), exponent);
+
+    return stats;
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "TransactionStore.h"
+
+//counting allocations of the whole test binary, so tests can check that loading doesn't allocate per row
+//it's a separate binary, so other tests keep the standard allocator (and sanitizers keep checking their new/delete)
+//all replaceable forms (array, nothrow and sized ones) are replaced, so every allocation is counted and freed by free()
+static std::atomic<size_t> allocationsCount(0);
+
+static void* countedAllocation(size_t size) noexcept
+{
+    ++allocationsCount;
+
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void* operator new(size_t size)
+{
+    void* pointer = countedAllocation(size);
+    if(pointer == nullptr) throw std::bad_alloc();
+
+    return pointer;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocation(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocation(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+TEST(txTests, setTransactionsAllocations)
+{
+    //account numbers longer than short string buffer, copying rows would allocate for every one
+    auto generate = [](unsigned int count){
+        std::vector<Transaction> transactions;
+        for(unsigned int i = 0; i < count; ++i)
+            transactions.push_back({ (i % 2 == 0) ? "35102049000000990200522828" : "56102055610000310200008433", count - i, 1.00 });
+        return transactions;
+    };
+
+    const std::vector<Transaction> small = generate(1000), big = generate(100000);
+
+    for(LoadAlgorithm algorithm : { LoadAlgorithm::ComparisonSort, LoadAlgorithm::RadixPartition })
+    {
+        TransactionStore db;
+        db.setLoadAlgorithm(algorithm);
+
+        size_t before = allocationsCount;
+        db.setTransactions(small);
+        const size_t smallAllocations = allocationsCount - before;
+
+        before = allocationsCount;
+        db.setTransactions(big);
+        const size_t bigAllocations = allocationsCount - before;
+
+        //only columns' growth depends on rows count
+        EXPECT_LT(bigAllocations, smallAllocations + 64);
+        EXPECT_EQ(100000, db.getStats().transactionsCount);
+    }
+
+    //consumed vector is taken by the store
+    std::vector<Transaction> consumed = big;
+    TransactionStore db(2), expected;
+    expected.setTransactions(big);
+    db.setTransactions(std::move(consumed));
+
+    EXPECT_TRUE(consumed.empty());
+    EXPECT_EQ(expected.getStats().transactionsCount, db.getStats().transactionsCount);
+    EXPECT_EQ(expected.calculateAverageAmount("56102055610000310200008433"), db.calculateAverageAmount("56102055610000310200008433"));
+
+    std::vector<Transaction> invalid = { {"35200442300000123", 1, 1.00}, {"invalid!", 2, 2.00} };
+    EXPECT_THROW(db.setTransactions(std::move(invalid)), AccountException);
+}
@@ -0,0 +1,98 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "AmountAggregate.h"
+
+namespace
+{
+    const size_t lanesCount = 4;        //independent accumulators, so the summing loop can be vectorized
+
+    //exponent of the scale which keeps |sum| <= DBL_MAX/2 for count amounts not greater than maxAbs
+    int requiredScaleExp(double maxAbs, size_t count)
+    {
+        if(count == 0 || maxAbs <= std::numeric_limits<double>::max() / (2.0 * static_cast<double>(count)))
+            return 0;
+
+        return -(std::ilogb(static_cast<double>(count)) + 2);
+    }
+
+    //Kahan-Babuska (Neumaier) step, also keeps low-order bits when added value is bigger than the sum
+    void kahanAdd(double& sum, double& compensation, double value)
+    {
+        double t = sum + value;
+        compensation += (std::fabs(sum) >= std::fabs(value)) ? ((sum - t) + value) : ((value - t) + sum);
+        sum = t;
+    }
+}
+
+//adding single amount [complexity: O(1)]
+void AmountAggregate::add(double amount)
+{
+    rescale(std::max(maxAbs, std::fabs(amount)), count + 1);
+
+    kahanAdd(sum, compensation, std::ldexp(amount, scaleExp));
+}
+
+//adding amounts in two passes, maximum first to choose the scale, then lane-wise compensated sum [complexity: O(n)]
+void AmountAggregate::add(const double* amounts, size_t amountsCount)
+{
+    double batchMaxAbs = maxAbs;
+    for(size_t i = 0; i < amountsCount; ++i)
+        batchMaxAbs = std::max(batchMaxAbs, std::fabs(amounts[i]));
+
+    rescale(batchMaxAbs, count + amountsCount);
+
+    const double scale = std::ldexp(1.0, scaleExp);
+    double lanesSum[lanesCount] = {}, lanesCompensation[lanesCount] = {};
+
+    size_t i = 0;
+    for(; i + lanesCount <= amountsCount; i += lanesCount)
+    {
+        for(size_t lane = 0; lane < lanesCount; ++lane)
+            kahanAdd(lanesSum[lane], lanesCompensation[lane], amounts[i + lane] * scale);
+    }
+
+    for(; i < amountsCount; ++i)
+        kahanAdd(lanesSum[0], lanesCompensation[0], amounts[i] * scale);
+
+    for(size_t lane = 0; lane < lanesCount; ++lane)
+    {
+        kahanAdd(sum, compensation, lanesSum[lane]);
+        kahanAdd(sum, compensation, lanesCompensation[lane]);
+    }
+}
+
+//adding amounts of other aggregate, its sum is rescaled to this aggregate's scale, which is never bigger [complexity: O(1)]
+void AmountAggregate::add(const AmountAggregate& other)
+{
+    if(other.count == 0) return;
+
+    rescale(std::max(maxAbs, other.maxAbs), count + other.count);
+
+    kahanAdd(sum, compensation, std::ldexp(other.sum, scaleExp - other.scaleExp));
+    kahanAdd(sum, compensation, std::ldexp(other.compensation, scaleExp - other.scaleExp));
+}
+
+double AmountAggregate::average() const
+{
+    if(count == 0) return 0.0;
+
+    //dividing before unscaling, so the result never exceeds the largest amount
+    return std::ldexp((sum + compensation) / static_cast<double>(count), -scaleExp);
+}
+
+//lowering the scale if sum of new count of amounts could overflow, scaling by power of two is exact
+void AmountAggregate::rescale(double newMaxAbs, size_t newCount)
+{
+    int newScaleExp = std::min(scaleExp, requiredScaleExp(newMaxAbs, newCount));
+
+    if(newScaleExp < scaleExp)
+    {
+        sum = std::ldexp(sum, newScaleExp - scaleExp);
+        compensation = std::ldexp(compensation, newScaleExp - scaleExp);
+        scaleExp = newScaleExp;
+    }
+
+    maxAbs = newMaxAbs;
+    count = newCount;
+}
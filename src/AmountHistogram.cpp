@@ -0,0 +1,53 @@
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include "AmountHistogram.h"
+
+namespace
+{
+    const size_t bucketsBlockSize = 256;    //amounts which buckets are calculated before counting
+}
+
+AmountHistogram::AmountHistogram(double minAmount, double maxAmount, size_t bucketsCount)
+    : minAmount(minAmount)
+    , maxAmount(maxAmount)
+    , halfMinAmount(minAmount * 0.5)
+    , bucketsPerHalfAmount(static_cast<double>(bucketsCount) / (maxAmount * 0.5 - minAmount * 0.5))
+{
+    if(bucketsCount == 0 || !(minAmount < maxAmount) || !std::isfinite(minAmount) || !std::isfinite(maxAmount))
+        throw std::invalid_argument("histogram has to have buckets and finite, non-empty range of amounts");
+
+    counts.resize(bucketsCount + 2);
+}
+
+void AmountHistogram::add(const double* amounts, size_t count)
+{
+    const size_t bucketsCount = getBucketsCount();
+    const double lastPosition = static_cast<double>(bucketsCount) - 0.5;
+    uint32_t positions[bucketsBlockSize];
+
+    for(size_t first = 0; first < count; first += bucketsBlockSize)
+    {
+        const size_t blockCount = (count - first < bucketsBlockSize) ? count - first : bucketsBlockSize;
+        const double* block = amounts + first;
+
+        //position -1 (and NaN) means below the range, rounding can't move amount below maxAmount to the last position
+        for(size_t i = 0; i < blockCount; ++i)
+        {
+            double position = (block[i] * 0.5 - halfMinAmount) * bucketsPerHalfAmount;
+            position = (position > -1.0) ? position : -1.0;
+            position = (position < lastPosition) ? position : lastPosition;
+
+            positions[i] = (block[i] >= maxAmount) ? static_cast<uint32_t>(bucketsCount + 1) : static_cast<uint32_t>(position + 1.0);
+        }
+
+        for(size_t i = 0; i < blockCount; ++i)
+            ++counts[positions[i]];
+    }
+}
+
+void AmountHistogram::add(const AmountHistogram& other)
+{
+    for(size_t i = 0; i < counts.size() && i < other.counts.size(); ++i)
+        counts[i] += other.counts[i];
+}
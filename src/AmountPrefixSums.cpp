@@ -0,0 +1,155 @@
+#include <cmath>
+#include <algorithm>
+#include "AmountPrefixSums.h"
+
+const size_t AmountPrefixSums::minPrefixCount;
+const size_t AmountPrefixSums::blockSize;
+
+namespace
+{
+    //error-free sum, value + error is exactly a + b
+    double twoSum(double a, double b, double& error)
+    {
+        double sum = a + b;
+        double bVirtual = sum - a;
+        error = (a - (sum - bVirtual)) + (b - bVirtual);
+        return sum;
+    }
+
+    //double-double sum, high + low + (lost bits) is exactly the sum of added values and lost is bound of lost bits
+    struct TrackedSum
+    {
+        double high;
+        double low;
+        double lost;
+        double lossesCount;
+
+        TrackedSum()
+            : high(0.0)
+            , low(0.0)
+            , lost(0.0)
+            , lossesCount(0.0)
+        {}
+
+        void add(double value)
+        {
+            double error, lowError;
+            high = twoSum(high, value, error);
+            low = twoSum(low, error, lowError);
+            lost += std::fabs(lowError);
+            lossesCount += (lowError != 0.0);
+        }
+
+        void add(const double* amounts, size_t first, size_t last, double scaleFactor)
+        {
+            for(size_t i = first; i < last; ++i)
+                add(amounts[i] * scaleFactor);
+        }
+
+        double value() const { return high + low; }
+
+        //no bits were lost, or they're far below the precision of the rounded sum
+        bool isAccurate(bool exact, double lostBound) const { return exact || lostBound <= std::ldexp(std::fabs(value()), -50); }
+    };
+}
+
+//running double-double sum, its state is saved at every block's start [complexity: O(n)]
+void AmountPrefixSums::build(const double* amounts, size_t count, int scale, ColumnArena* arena)
+{
+    scaleExp = scale;
+    ArenaVector<Prefix>(ArenaAllocator<Prefix>(arena)).swap(prefixes);
+
+    if(count < minPrefixCount) return;
+
+    prefixes.reserve(count / blockSize + 1);
+
+    const double scaleFactor = std::ldexp(1.0, scaleExp);
+    TrackedSum sum;
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(i % blockSize == 0) prefixes.push_back(Prefix{ sum.high, sum.low, sum.lost, sum.lossesCount });
+
+        sum.add(amounts[i] * scaleFactor);
+    }
+
+    if(count % blockSize == 0) prefixes.push_back(Prefix{ sum.high, sum.low, sum.lost, sum.lossesCount });
+}
+
+//prefixes at block boundaries nearest to range's ends are used, amounts between the boundaries and the ends are added
+//or subtracted, so at most half of block is summed at every end
+double AmountPrefixSums::scaledSum(const double* amounts, size_t first, size_t last) const
+{
+    const double scaleFactor = std::ldexp(1.0, scaleExp);
+    const size_t firstBlock = (first + blockSize / 2) / blockSize;
+    const size_t lastBlock = prefixes.empty() ? 0 : std::min((last + blockSize / 2) / blockSize, prefixes.size() - 1);
+
+    //small accounts and ranges shorter than block
+    if(prefixes.empty() || firstBlock >= lastBlock)
+    {
+        TrackedSum sum;
+        sum.add(amounts, first, last, scaleFactor);
+        return sum.value();
+    }
+
+    auto addEnds = [&](TrackedSum& sum){
+        sum.add(amounts, first, std::max(first, firstBlock * blockSize), scaleFactor);
+        sum.add(amounts, std::min(first, firstBlock * blockSize), first, -scaleFactor);
+        sum.add(amounts, std::min(last, lastBlock * blockSize), last, scaleFactor);
+        sum.add(amounts, last, std::max(last, lastBlock * blockSize), -scaleFactor);
+    };
+
+    //difference of prefixes, high and low parts are exact values, so only bits lost between the prefixes are unknown
+    //(running sum of lost bits itself is rounded by at most its relative error for last additions)
+    const Prefix& firstPrefix = prefixes[firstBlock];
+    const Prefix& lastPrefix = prefixes[lastBlock];
+
+    TrackedSum sum;
+    sum.add(lastPrefix.high);
+    sum.add(-firstPrefix.high);
+    sum.add(lastPrefix.low);
+    sum.add(-firstPrefix.low);
+    addEnds(sum);
+
+    const bool exact = (sum.lossesCount == 0.0 && lastPrefix.lossesCount == firstPrefix.lossesCount);
+    const double lostBound = sum.lost + (lastPrefix.lost - firstPrefix.lost) + lastPrefix.lost * std::ldexp(static_cast<double>(last), -52);
+
+    if(sum.isAccurate(exact, lostBound)) return sum.value();
+
+    //range cancelled out below the lost bits, blocks which didn't lose bits are exact differences of their prefixes,
+    //the others are summed amount by amount
+    TrackedSum blocksSum;
+    addEnds(blocksSum);
+
+    for(size_t block = firstBlock; block < lastBlock; ++block)
+    {
+        if(prefixes[block + 1].lossesCount == prefixes[block].lossesCount)
+        {
+            blocksSum.add(prefixes[block + 1].high);
+            blocksSum.add(-prefixes[block].high);
+            blocksSum.add(prefixes[block + 1].low);
+            blocksSum.add(-prefixes[block].low);
+        }
+        else
+        {
+            blocksSum.add(amounts, block * blockSize, (block + 1) * blockSize, scaleFactor);
+        }
+    }
+
+    return blocksSum.value();
+}
+
+double AmountPrefixSums::sum(const double* amounts, size_t first, size_t last) const
+{
+    if(first >= last) return 0.0;
+
+    return std::ldexp(scaledSum(amounts, first, last), -scaleExp);
+}
+
+double AmountPrefixSums::average(const double* amounts, size_t first, size_t last) const
+{
+    if(first >= last) return 0.0;
+
+    //dividing before unscaling, so the result never exceeds the largest amount
+    return std::ldexp(scaledSum(amounts, first, last) / static_cast<double>(last - first), -scaleExp);
+}
@@ -0,0 +1,75 @@
+#include <limits>
+#include <algorithm>
+#include "AmountRangeTree.h"
+
+const size_t AmountRangeTree::leafSize;
+const size_t AmountRangeTree::minTreeCount;
+
+void AmountRangeTree::build(const double* amounts, size_t count, ColumnArena* arena)
+{
+    leavesCount = 0;
+    ArenaVector<Node>(ArenaAllocator<Node>(arena)).swap(nodes);
+
+    if(count < minTreeCount) return;
+
+    leavesCount = (count + leafSize - 1) / leafSize;
+    nodes.resize(2 * leavesCount);
+
+    for(size_t leaf = 0; leaf < leavesCount; ++leaf)
+    {
+        Node& node = nodes[leavesCount + leaf];
+        node = Node{ std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+
+        addAmounts(amounts, leaf * leafSize, std::min(count, (leaf + 1) * leafSize), node);
+    }
+
+    for(size_t i = leavesCount - 1; i > 0; --i)
+    {
+        nodes[i] = nodes[2 * i];
+        addNode(nodes[2 * i + 1], nodes[i]);
+    }
+}
+
+void AmountRangeTree::addAmounts(const double* amounts, size_t first, size_t last, Node& node)
+{
+    for(size_t i = first; i < last; ++i)
+    {
+        node.minAmount = std::min(node.minAmount, amounts[i]);
+        node.maxAmount = std::max(node.maxAmount, amounts[i]);
+    }
+}
+
+void AmountRangeTree::addNode(const Node& other, Node& node)
+{
+    node.minAmount = std::min(node.minAmount, other.minAmount);
+    node.maxAmount = std::max(node.maxAmount, other.maxAmount);
+}
+
+std::pair<double, double> AmountRangeTree::minMax(const double* amounts, size_t first, size_t last) const
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    if(first >= last) return std::make_pair(nan, nan);
+
+    Node result{ std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+
+    //whole leaves inside the range
+    size_t firstLeaf = (first + leafSize - 1) / leafSize, lastLeaf = last / leafSize;
+
+    if(leavesCount == 0 || firstLeaf >= lastLeaf)
+    {
+        addAmounts(amounts, first, last, result);
+    }
+    else
+    {
+        addAmounts(amounts, first, firstLeaf * leafSize, result);
+        addAmounts(amounts, lastLeaf * leafSize, last, result);
+
+        for(size_t left = firstLeaf + leavesCount, right = lastLeaf + leavesCount; left < right; left /= 2, right /= 2)
+        {
+            if(left & 1) addNode(nodes[left++], result);
+            if(right & 1) addNode(nodes[--right], result);
+        }
+    }
+
+    return std::make_pair(result.minAmount, result.maxAmount);
+}
@@ -0,0 +1,75 @@
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include "BlockedBloomFilter.h"
+
+const size_t BlockedBloomFilter::blockWordsCount;
+
+const unsigned int BlockedBloomFilter::pageShift;
+const size_t BlockedBloomFilter::pageBlocks;
+
+std::shared_ptr<uint64_t> BlockedBloomFilter::allocatePage(size_t bytes)
+{
+    void* memory = nullptr;
+    if(posix_memalign(&memory, 64, bytes) != 0)
+        throw std::bad_alloc();
+
+    return std::shared_ptr<uint64_t>(static_cast<uint64_t*>(memory), std::free);
+}
+
+//bits per hash of standard Bloom filter are increased by a fifth, which covers uneven load of blocks
+//for rates used in practice (0.1% - 10%) [complexity: O(expectedCount)]
+void BlockedBloomFilter::build(size_t expectedCount, double falsePositiveRate)
+{
+    const double ln2 = std::log(2.0);
+    const double bitsPerKey = -std::log(falsePositiveRate) / (ln2 * ln2);
+
+    bitsPerHash = static_cast<unsigned int>(std::min(16.0, std::max(1.0, std::round(bitsPerKey * ln2))));
+    capacity = std::max<size_t>(expectedCount, 1);
+    added = 0;
+
+    size_t bits = static_cast<size_t>(std::ceil(capacity * bitsPerKey * 1.2));
+    blocksCount = (bits + blockWordsCount * 64 - 1) / (blockWordsCount * 64);
+
+    pages.clear();
+    pages.reserve((blocksCount + pageBlocks - 1) >> pageShift);
+    for(size_t page = 0; page << pageShift < blocksCount; ++page)
+    {
+        pages.push_back(allocatePage(pageBytes(page)));
+        std::memset(pages.back().get(), 0, pageBytes(page));
+    }
+}
+
+void BlockedBloomFilter::clear()
+{
+    std::vector<std::shared_ptr<uint64_t> >().swap(pages);
+    blocksCount = 0;
+    bitsPerHash = 0;
+    capacity = 0;
+    added = 0;
+}
+
+//page still shared with other copy of filter is cloned first [complexity: O(1), O(page) when page is shared]
+void BlockedBloomFilter::add(uint64_t hash)
+{
+    if(blocksCount == 0) return;
+
+    const size_t pageIndex = blockIndex(hash) >> pageShift;
+    std::shared_ptr<uint64_t>& page = pages[pageIndex];
+    if(page.use_count() > 1)
+    {
+        std::shared_ptr<uint64_t> copy = allocatePage(pageBytes(pageIndex));
+        std::memcpy(copy.get(), page.get(), pageBytes(pageIndex));
+        page = std::move(copy);
+    }
+
+    uint64_t* block = const_cast<uint64_t*>(blockWords(hash));
+    uint32_t bit = firstBit(hash), step = bitStep(hash);
+
+    for(unsigned int i = 0; i < bitsPerHash; ++i, bit += step)
+        block[(bit >> 6) & 7] |= (1ull << (bit & 63));
+
+    ++added;
+}
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include "ColumnArena.h"
+
+const size_t ColumnArena::minSlabSize;
+
+void ColumnArena::reserve(size_t bytes)
+{
+    if(bytes == 0) return;
+
+    slabs.push_back(Slab{ std::unique_ptr<char[]>(new char[bytes]), bytes });
+    used = 0;
+}
+
+//bumping pointer in the last slab, new slab is added when allocation doesn't fit [complexity: O(1)]
+void* ColumnArena::allocate(size_t bytes, size_t alignment)
+{
+    size_t offset = (used + alignment - 1) & ~(alignment - 1);
+
+    if(slabs.empty() || offset + bytes > slabs.back().size)
+    {
+        reserve(std::max(minSlabSize, bytes + alignment));
+        offset = 0;
+    }
+
+    used = offset + bytes;
+
+    return slabs.back().data.get() + offset;
+}
+
+size_t ColumnArena::memoryUsage() const
+{
+    size_t bytes = 0;
+    for(const Slab& slab : slabs)
+        bytes += slab.size;
+
+    return bytes;
+}
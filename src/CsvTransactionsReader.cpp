@@ -0,0 +1,183 @@
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cerrno>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+#include "CsvTransactionsReader.h"
+#include "TransactionStoreExceptions.h"
+
+namespace
+{
+    inline bool isDigit(char c)
+    {
+        return static_cast<unsigned char>(c - '0') < 10;
+    }
+
+    //integer cents below 2^53 are exact doubles, so one correctly rounded division gives the nearest double
+    const size_t maxExactIntegerDigits = 13;
+    const size_t maxFallbackLength = 64;
+}
+
+CsvTransactionsReader::CsvTransactionsReader(int fd, size_t chunkSize)
+    : fd(fd)
+    , buffer(chunkSize)
+    , position(0)
+    , filled(0)
+    , line(0)
+    , totalRead(0)
+    , endOfData(false)
+{}
+
+//moving unparsed rest of the buffer to its beginning and reading next chunk after it
+void CsvTransactionsReader::refill()
+{
+    if(position == 0 && filled == buffer.size())
+        throw TransactionsFormatException(line + 1, "line is longer than read buffer");
+
+    std::memmove(buffer.data(), buffer.data() + position, filled - position);
+    filled -= position;
+    position = 0;
+
+    ssize_t count;
+    do
+    {
+        count = ::read(fd, buffer.data() + filled, buffer.size() - filled);
+    }
+    while(count < 0 && errno == EINTR);
+
+    if(count < 0) throw std::system_error(errno, std::generic_category(), "can't read transactions data");
+
+    endOfData = (count == 0);
+    filled += static_cast<size_t>(count);
+    totalRead += static_cast<size_t>(count);
+}
+
+//[complexity: O(line length), amortized over chunk reads]
+bool CsvTransactionsReader::next(TransactionRecord& record)
+{
+    for(;;)
+    {
+        const char* lineStart = buffer.data() + position;
+        const char* lineEnd = static_cast<const char*>(std::memchr(lineStart, '\n', filled - position));
+
+        if(lineEnd == nullptr)
+        {
+            if(!endOfData)
+            {
+                refill();
+                continue;
+            }
+
+            //last line without newline
+            if(position == filled) return false;
+            lineEnd = buffer.data() + filled;
+        }
+
+        position = std::min(filled, static_cast<size_t>(lineEnd - buffer.data()) + 1);
+        ++line;
+
+        if(lineEnd != lineStart && lineEnd[-1] == '\r') --lineEnd;
+        if(lineEnd == lineStart) continue;
+
+        parseLine(lineStart, lineEnd, record);
+        return true;
+    }
+}
+
+//transaction number is read until the second comma, so short fields aren't scanned twice
+void CsvTransactionsReader::parseLine(const char* first, const char* last, TransactionRecord& record) const
+{
+    const char* accNoEnd = static_cast<const char*>(std::memchr(first, ',', last - first));
+    if(accNoEnd == nullptr)
+        throw TransactionsFormatException(line, "expected accNo,txNo,amount");
+
+    record.accNo = first;
+    record.accNoLength = static_cast<size_t>(accNoEnd - first);
+
+    const char* txNoEnd = accNoEnd + 1;
+    while(txNoEnd != last && isDigit(*txNoEnd) && txNoEnd - accNoEnd <= 10)
+        ++txNoEnd;
+
+    if(txNoEnd == last || *txNoEnd != ',' || !parseTxNo(accNoEnd + 1, txNoEnd, record.txNo))
+        throw TransactionsFormatException(line, "invalid transaction number");
+
+    if(!parseAmount(txNoEnd + 1, last, record.amount))
+        throw TransactionsFormatException(line, "invalid amount");
+}
+
+//[complexity: O(digits)]
+bool parseTxNo(const char* first, const char* last, unsigned int& txNo)
+{
+    if(first == last) return false;
+
+    uint64_t value = 0;
+    for(const char* it = first; it != last; ++it)
+    {
+        if(!isDigit(*it)) return false;
+
+        value = value * 10 + static_cast<uint64_t>(*it - '0');
+        if(value > std::numeric_limits<unsigned int>::max()) return false;
+    }
+
+    txNo = static_cast<unsigned int>(value);
+    return true;
+}
+
+//[complexity: O(digits)]
+bool parseAmount(const char* first, const char* last, double& amount)
+{
+    const char* it = first;
+    bool negative = (it != last && *it == '-');
+    if(it != last && (*it == '-' || *it == '+')) ++it;
+
+    const char* integerStart = it;
+    int64_t cents = 0;
+
+    for(; it != last && isDigit(*it); ++it)
+    {
+        if(static_cast<size_t>(it - integerStart) < maxExactIntegerDigits)
+            cents = cents * 10 + (*it - '0');
+    }
+
+    size_t integerDigits = static_cast<size_t>(it - integerStart);
+    size_t fractionDigits = 0;
+
+    if(integerDigits <= maxExactIntegerDigits)
+    {
+        if(it != last && *it == '.')
+        {
+            ++it;
+            while(it != last && isDigit(*it) && fractionDigits < 3)
+            {
+                cents = cents * 10 + (*it++ - '0');
+                ++fractionDigits;
+            }
+        }
+
+        if(it == last && fractionDigits <= 2 && integerDigits + fractionDigits > 0)
+        {
+            static const double scales[3] = { 1.0, 10.0, 100.0 };
+
+            amount = static_cast<double>(negative ? -cents : cents) / scales[fractionDigits];
+            return true;
+        }
+    }
+
+    //more decimal places, exponent or very large value
+    size_t length = static_cast<size_t>(last - first);
+    if(length == 0 || length >= maxFallbackLength) return false;
+
+    char text[maxFallbackLength];
+    std::memcpy(text, first, length);
+    text[length] = 0;
+
+    char* end = nullptr;
+    amount = std::strtod(text, &end);
+
+    return end == text + length && std::isfinite(amount);
+}
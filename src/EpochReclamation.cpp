@@ -0,0 +1,83 @@
+#include <thread>
+#include <cstdlib>
+#include <new>
+#include "EpochReclamation.h"
+
+std::atomic<uint64_t> EpochDomain::globalEpoch(1);
+std::atomic<EpochDomain::ReaderSlot*> EpochDomain::slots(nullptr);
+
+EpochDomain::ReadGuard::ReadGuard()
+{
+    ReaderSlot& slot = threadSlot();
+
+    //fence orders announcement before reading of published pointer (even if pointer is loaded only with acquire),
+    //so writer either sees the announcement or this reader sees the new pointer
+    if(slot.nesting++ == 0)
+    {
+        slot.epoch.store(globalEpoch.load());
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+EpochDomain::ReadGuard::~ReadGuard()
+{
+    ReaderSlot& slot = threadSlot();
+
+    if(--slot.nesting == 0)
+        slot.epoch.store(0, std::memory_order_release);
+}
+
+//readers which announced older epoch could read unpublished pointer, newer ones see already the new one
+void EpochDomain::synchronize()
+{
+    const uint64_t epoch = globalEpoch.fetch_add(1) + 1;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    for(ReaderSlot* slot = slots.load(); slot != nullptr; slot = slot->next)
+    {
+        uint64_t readerEpoch;
+        while((readerEpoch = slot->epoch.load()) != 0 && readerEpoch < epoch)
+            std::this_thread::yield();
+    }
+}
+
+EpochDomain::ReaderSlot& EpochDomain::threadSlot()
+{
+    static thread_local ThreadSlot threadSlot;
+
+    return *(threadSlot.slot);
+}
+
+//reusing slot of finished thread or adding new one to the list
+EpochDomain::ReaderSlot* EpochDomain::acquireSlot()
+{
+    for(ReaderSlot* slot = slots.load(); slot != nullptr; slot = slot->next)
+    {
+        bool expected = false;
+        if(slot->used.compare_exchange_strong(expected, true)) return slot;
+    }
+
+    //plain new doesn't have to respect slot's alignment before C++17, slots are never freed
+    void* memory = nullptr;
+    if(posix_memalign(&memory, alignof(ReaderSlot), sizeof(ReaderSlot)) != 0) throw std::bad_alloc();
+
+    ReaderSlot* slot = new(memory) ReaderSlot();
+    slot->epoch.store(0);
+    slot->used.store(true);
+    slot->nesting = 0;
+    slot->next = slots.load();
+
+    while(!slots.compare_exchange_weak(slot->next, slot))
+    {}
+
+    return slot;
+}
+
+EpochDomain::ThreadSlot::ThreadSlot()
+    : slot(acquireSlot())
+{}
+
+EpochDomain::ThreadSlot::~ThreadSlot()
+{
+    slot->used.store(false, std::memory_order_release);
+}
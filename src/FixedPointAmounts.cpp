@@ -0,0 +1,134 @@
+#include <cmath>
+#include <algorithm>
+#include "FixedPointAmounts.h"
+
+const size_t CentsPrefixSums::minPrefixCount;
+const size_t CentsPrefixSums::blockSize;
+
+namespace
+{
+    //2^10 cents below 2^53 can't overflow 64 bits
+    const size_t centsBlockSize = 1024;
+
+    typedef unsigned __int128 CentsMagnitude;
+
+    int bitsCount(CentsMagnitude value)
+    {
+        const uint64_t high = static_cast<uint64_t>(value >> 64), low = static_cast<uint64_t>(value);
+
+        if(high != 0) return 128 - __builtin_clzll(high);
+        return (low != 0) ? 64 - __builtin_clzll(low) : 0;
+    }
+
+    //nearest double to numerator / divisor (divisor < 2^72), numerator is shifted so the quotient has at least 55 bits,
+    //remainder and dropped bits are kept as sticky bit below them, so the only rounding is conversion to double
+    double roundedQuotient(CentsSum numerator, CentsMagnitude divisor)
+    {
+        if(numerator == 0) return 0.0;
+
+        const bool negative = numerator < 0;
+        CentsMagnitude magnitude = negative ? -static_cast<CentsMagnitude>(numerator) : static_cast<CentsMagnitude>(numerator);
+
+        const int shift = std::max(0, 55 + bitsCount(divisor) - bitsCount(magnitude));
+        magnitude <<= shift;
+
+        CentsMagnitude quotient = magnitude / divisor;
+        bool sticky = (magnitude % divisor) != 0;
+
+        const int drop = std::max(0, bitsCount(quotient) - 62);
+        sticky |= (quotient & ((CentsMagnitude(1) << drop) - 1)) != 0;
+        quotient >>= drop;
+
+        const double value = std::ldexp(static_cast<double>(static_cast<int64_t>((quotient << 1) | sticky)), drop - shift - 1);
+
+        return negative ? -value : value;
+    }
+}
+
+bool amountToCents(double amount, int64_t& cents)
+{
+    if(!(std::fabs(amount) < maxFixedPointAmount)) return false;
+
+    cents = std::llround(amount * 100.0);
+
+    //division is correctly rounded, so it gives the same double as parsing the amount with two decimal digits
+    return (static_cast<double>(cents) / 100.0 == amount);
+}
+
+CentsSum sumCents(const int64_t* cents, size_t count)
+{
+    CentsSum sum = 0;
+
+    for(size_t first = 0; first < count; first += centsBlockSize)
+    {
+        const size_t last = (count - first < centsBlockSize) ? count : first + centsBlockSize;
+
+        int64_t blockSum = 0;
+        for(size_t i = first; i < last; ++i)
+            blockSum += cents[i];
+
+        sum += blockSum;
+    }
+
+    return sum;
+}
+
+double sumOfCents(CentsSum sum)
+{
+    return roundedQuotient(sum, 100);
+}
+
+double averageOfCents(CentsSum sum, size_t count)
+{
+    if(count == 0) return 0.0;
+
+    return roundedQuotient(sum, static_cast<CentsMagnitude>(count) * 100);
+}
+
+void CentsPrefixSums::build(const int64_t* cents, size_t count, ColumnArena* arena)
+{
+    ArenaVector<CentsSum>(ArenaAllocator<CentsSum>(arena)).swap(prefixes);
+
+    if(count < minPrefixCount) return;
+
+    prefixes.reserve(count / blockSize + 1);
+    prefixes.push_back(0);
+
+    for(size_t first = 0; first + blockSize <= count; first += blockSize)
+        prefixes.push_back(prefixes.back() + sumCents(cents + first, blockSize));
+}
+
+//prefixes at block boundaries nearest to range's ends are used, cents between the boundaries and the ends are added
+//or subtracted, so at most half of block is summed at every end
+CentsSum CentsPrefixSums::rangeSum(const int64_t* cents, size_t first, size_t last) const
+{
+    const size_t firstBlock = (first + blockSize / 2) / blockSize;
+    const size_t lastBlock = prefixes.empty() ? 0 : std::min((last + blockSize / 2) / blockSize, prefixes.size() - 1);
+
+    if(prefixes.empty() || firstBlock >= lastBlock) return sumCents(cents + first, last - first);
+
+    const size_t firstBoundary = firstBlock * blockSize, lastBoundary = lastBlock * blockSize;
+    CentsSum sum = prefixes[lastBlock] - prefixes[firstBlock];
+
+    if(first < firstBoundary) sum += sumCents(cents + first, firstBoundary - first);
+    else sum -= sumCents(cents + firstBoundary, first - firstBoundary);
+
+    if(lastBoundary < last) sum += sumCents(cents + lastBoundary, last - lastBoundary);
+    else sum -= sumCents(cents + last, lastBoundary - last);
+
+    return sum;
+}
+
+double CentsPrefixSums::sum(const int64_t* cents, size_t first, size_t last) const
+{
+    if(first >= last) return 0.0;
+
+    return sumOfCents(rangeSum(cents, first, last));
+}
+
+double CentsPrefixSums::average(const int64_t* cents, size_t first, size_t last) const
+{
+    if(first >= last) return 0.0;
+
+    return averageOfCents(rangeSum(cents, first, last), last - first);
+}
@@ -0,0 +1,186 @@
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "MappedTransactionStore.h"
+
+MappedTransactionStore::MappedTransactionStore(const std::string& path, bool verifyData)
+    : path(path)
+    , mapping(nullptr)
+    , mappingSize(0)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) throw SnapshotFileException(path, "can't open snapshot file");
+
+    struct stat fileStat;
+    if(::fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(SnapshotFileHeader))
+    {
+        ::close(fd);
+        throw SnapshotFileException(path, "snapshot file is too small");
+    }
+
+    mappingSize = static_cast<size_t>(fileStat.st_size);
+    mapping = ::mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if(mapping == MAP_FAILED)
+    {
+        mapping = nullptr;
+        throw SnapshotFileException(path, "can't map snapshot file");
+    }
+
+    const char* file = static_cast<const char*>(mapping);
+    header = reinterpret_cast<const SnapshotFileHeader*>(file);
+
+    try
+    {
+        verifyHeader(mappingSize);
+
+        if(verifyData && snapshotChecksum(file + sizeof(SnapshotFileHeader), mappingSize - sizeof(SnapshotFileHeader)) != header->dataChecksum)
+            throw SnapshotFileException(path, "snapshot data checksum mismatch");
+
+        entries = reinterpret_cast<const SnapshotAccountEntry*>(file + header->accountsOffset);
+        index = reinterpret_cast<const SnapshotIndexSlot*>(file + header->indexOffset);
+        txNos = reinterpret_cast<const unsigned int*>(file + header->txNosOffset);
+        amounts = reinterpret_cast<const double*>(file + header->amountsOffset);
+
+        verifyAccounts();
+    }
+    catch(...)
+    {
+        unmap();
+        throw;
+    }
+
+    //index is probed randomly, the rest is mostly read in order
+    ::madvise(const_cast<char*>(file) + header->indexOffset, header->indexCapacity * sizeof(SnapshotIndexSlot), MADV_RANDOM);
+}
+
+MappedTransactionStore::~MappedTransactionStore()
+{
+    unmap();
+}
+
+void MappedTransactionStore::unmap()
+{
+    if(mapping != nullptr)
+        ::munmap(mapping, mappingSize);
+
+    mapping = nullptr;
+}
+
+//checking that header is intact and all sections lie inside the file [complexity: O(1)]
+void MappedTransactionStore::verifyHeader(size_t fileSize) const
+{
+    if(std::memcmp(header->magic, snapshotMagic, sizeof(header->magic)) != 0)
+        throw SnapshotFileException(path, "not a snapshot file");
+
+    if(header->version != snapshotVersion || header->headerSize != sizeof(SnapshotFileHeader))
+        throw SnapshotFileException(path, "unsupported snapshot version");
+
+    if(snapshotChecksum(header, offsetof(SnapshotFileHeader, headerChecksum)) != header->headerChecksum)
+        throw SnapshotFileException(path, "snapshot header checksum mismatch");
+
+    if(header->fileSize != fileSize)
+        throw SnapshotFileException(path, "snapshot file is truncated");
+
+    bool capacityValid = header->indexCapacity != 0 && (header->indexCapacity & (header->indexCapacity - 1)) == 0 && header->indexCapacity > header->accountsCount;
+    bool layoutValid = header->accountsOffset + header->accountsCount * sizeof(SnapshotAccountEntry) <= header->indexOffset
+        && header->indexOffset + header->indexCapacity * sizeof(SnapshotIndexSlot) <= header->txNosOffset
+        && header->txNosOffset + header->transactionsCount * sizeof(unsigned int) <= header->amountsOffset
+        && header->amountsOffset + header->transactionsCount * sizeof(double) <= fileSize;
+
+    if(!capacityValid || !layoutValid || header->accountsOffset < sizeof(SnapshotFileHeader))
+        throw SnapshotFileException(path, "snapshot layout is invalid");
+}
+
+//checking values which lookups use unchecked, even without verifyData: index slots point to existing entries and
+//at least one is empty (so probing ends), entries' transactions lie inside columns [complexity: O(accounts + index)]
+void MappedTransactionStore::verifyAccounts() const
+{
+    bool emptySlot = false;
+    for(uint64_t slot = 0; slot < header->indexCapacity; ++slot)
+    {
+        if(index[slot] > header->accountsCount)
+            throw SnapshotFileException(path, "snapshot index is invalid");
+
+        emptySlot |= (index[slot] == 0);
+    }
+
+    if(!emptySlot)
+        throw SnapshotFileException(path, "snapshot index is invalid");
+
+    for(uint64_t i = 0; i < header->accountsCount; ++i)
+    {
+        if(entries[i].transactionsCount > header->transactionsCount
+            || entries[i].firstTransaction > header->transactionsCount - entries[i].transactionsCount)
+            throw SnapshotFileException(path, "snapshot account entry is invalid");
+    }
+}
+
+//looking up account in file's index, index always has empty slots (verified at open) so probing ends [complexity: mostly O(1)]
+const SnapshotAccountEntry& MappedTransactionStore::getAccount(const std::string& accNo) const
+{
+    AccountKey key;
+    if(key.assign(accNo.data(), accNo.size()))
+    {
+        const uint64_t mask = header->indexCapacity - 1;
+
+        for(uint64_t slot = key.hash() & mask; index[slot] != 0; slot = (slot + 1) & mask)
+        {
+            const SnapshotAccountEntry& entry = entries[index[slot] - 1];
+            if(entry.accNo == key)
+                return entry;
+        }
+    }
+
+    throw AccountException(accNo);
+}
+
+Transaction MappedTransactionStore::findTransaction(const std::string &accNo, int txNo)
+{
+    if(txNo < 0) throw TransactionException(accNo, txNo);
+
+    const SnapshotAccountEntry& account = getAccount(accNo);
+    const unsigned int* first = txNos + account.firstTransaction;
+    const unsigned int* last = first + account.transactionsCount;
+
+    const unsigned int* transIt = std::lower_bound(first, last, static_cast<unsigned int>(txNo));
+    if(transIt == last || *transIt != static_cast<unsigned int>(txNo))
+        throw TransactionException(accNo, txNo);
+
+    return Transaction{ account.accNo.toString(), *transIt, amounts[transIt - txNos] };
+}
+
+std::vector<Transaction> MappedTransactionStore::findTransactions(const std::string &accNo)
+{
+    auto view = findTransactionsView(accNo);
+
+    std::vector<Transaction> transactions;
+    transactions.reserve(view.size());
+
+    for(size_t i = 0; i < view.size(); ++i)
+        transactions.push_back(view[i]);
+
+    return transactions;
+}
+
+TransactionsView MappedTransactionStore::findTransactionsView(const std::string &accNo) const
+{
+    const SnapshotAccountEntry& account = getAccount(accNo);
+
+    return TransactionsView(account.accNo, txNos + account.firstTransaction, amounts + account.firstTransaction, account.transactionsCount);
+}
+
+double MappedTransactionStore::calculateAverageAmount(const std::string &accNo)
+{
+    return getAccount(accNo).averageAmount;
+}
+
+void MappedTransactionStore::setTransactions(const std::vector<Transaction> &)
+{
+    throw SnapshotFileException(path, "snapshot store is read-only");
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cstring>
+#include "RadixSort.h"
+
+const size_t TxNoRadixSorter::minRadixCount;
+
+namespace
+{
+    const unsigned int digitBits = 8;
+    const size_t digitsCount = 4, bucketsCount = 1 << digitBits;
+}
+
+void TxNoRadixSorter::sort(unsigned int* txNos, double* amounts, size_t count)
+{
+    if(count < minRadixCount)
+    {
+        insertionSort(txNos, amounts, count);
+        return;
+    }
+
+    //histograms of all digits at once, rows which are already sorted aren't moved at all
+    size_t histograms[digitsCount][bucketsCount] = {};
+    bool sorted = true;
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        const unsigned int txNo = txNos[i];
+        for(size_t digit = 0; digit < digitsCount; ++digit)
+            ++histograms[digit][(txNo >> (digit * digitBits)) & (bucketsCount - 1)];
+
+        sorted &= (i == 0 || txNos[i - 1] <= txNo);
+    }
+
+    if(sorted) return;
+
+    txNosBuffer.resize(count);
+    amountsBuffer.resize(count);
+
+    unsigned int* sourceTxNos = txNos;
+    double* sourceAmounts = amounts;
+    unsigned int* targetTxNos = txNosBuffer.data();
+    double* targetAmounts = amountsBuffer.data();
+
+    for(size_t digit = 0; digit < digitsCount; ++digit)
+    {
+        size_t* histogram = histograms[digit];
+        const unsigned int shift = static_cast<unsigned int>(digit * digitBits);
+
+        //all rows have the same digit, pass wouldn't change the order
+        if(histogram[(sourceTxNos[0] >> shift) & (bucketsCount - 1)] == count) continue;
+
+        size_t offset = 0;
+        for(size_t bucket = 0; bucket < bucketsCount; ++bucket)
+        {
+            size_t bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            size_t position = histogram[(sourceTxNos[i] >> shift) & (bucketsCount - 1)]++;
+            targetTxNos[position] = sourceTxNos[i];
+            targetAmounts[position] = sourceAmounts[i];
+        }
+
+        std::swap(sourceTxNos, targetTxNos);
+        std::swap(sourceAmounts, targetAmounts);
+    }
+
+    //odd number of passes leaves the result in buffers
+    if(sourceTxNos != txNos)
+    {
+        std::memcpy(txNos, sourceTxNos, count * sizeof(unsigned int));
+        std::memcpy(amounts, sourceAmounts, count * sizeof(double));
+    }
+}
+
+//stable, rows are moved only past bigger txNos
+void TxNoRadixSorter::insertionSort(unsigned int* txNos, double* amounts, size_t count)
+{
+    for(size_t i = 1; i < count; ++i)
+    {
+        const unsigned int txNo = txNos[i];
+        const double amount = amounts[i];
+
+        size_t j = i;
+        for(; j > 0 && txNos[j - 1] > txNo; --j)
+        {
+            txNos[j] = txNos[j - 1];
+            amounts[j] = amounts[j - 1];
+        }
+
+        txNos[j] = txNo;
+        amounts[j] = amount;
+    }
+}
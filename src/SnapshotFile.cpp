@@ -0,0 +1,153 @@
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "SnapshotFile.h"
+#include "TransactionStore.h"
+#include "TransactionStoreExceptions.h"
+
+namespace
+{
+    const uint64_t prime1 = 0x9E3779B185EBCA87ull;
+    const uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+
+    inline uint64_t rotate(uint64_t val, int bits)
+    {
+        return (val << bits) | (val >> (64 - bits));
+    }
+
+    inline uint64_t round(uint64_t acc, uint64_t word)
+    {
+        return rotate(acc + word * prime2, 31) * prime1;
+    }
+
+    inline uint64_t alignSection(uint64_t offset)
+    {
+        return (offset + 63) & ~static_cast<uint64_t>(63);
+    }
+
+    template<typename T>
+    T* section(char* file, uint64_t offset)
+    {
+        return reinterpret_cast<T*>(file + offset);
+    }
+
+    void removeFile(int fd, const std::string& path)
+    {
+        if(fd >= 0) ::close(fd);
+        ::unlink(path.c_str());
+    }
+}
+
+//file is created with its final size and filled through mmap, so the data isn't copied through another buffer [complexity: O(n)]
+void writeSnapshotFile(const StoreSnapshot& snapshot, const std::string& path)
+{
+    const StoreSnapshot::AccountsMap& accounts = snapshot.accounts;
+
+    SnapshotFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, snapshotMagic, sizeof(header.magic));
+    header.version = snapshotVersion;
+    header.headerSize = sizeof(SnapshotFileHeader);
+    header.accountsCount = accounts.size();
+
+    for(const AccountTransactions& account : accounts)
+        header.transactionsCount += account.txNos.size();
+
+    //index has at most half of slots used, so probing sequences are short
+    header.indexCapacity = 1;
+    while(header.indexCapacity < 2 * header.accountsCount)
+        header.indexCapacity *= 2;
+
+    header.accountsOffset = alignSection(sizeof(SnapshotFileHeader));
+    header.indexOffset = alignSection(header.accountsOffset + header.accountsCount * sizeof(SnapshotAccountEntry));
+    header.txNosOffset = alignSection(header.indexOffset + header.indexCapacity * sizeof(SnapshotIndexSlot));
+    header.amountsOffset = alignSection(header.txNosOffset + header.transactionsCount * sizeof(unsigned int));
+    header.fileSize = header.amountsOffset + header.transactionsCount * sizeof(double);
+
+    const std::string tempPath = path + ".tmp";
+    int fd = ::open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) throw SnapshotFileException(path, "can't create snapshot file");
+
+    if(::ftruncate(fd, static_cast<off_t>(header.fileSize)) != 0)
+    {
+        removeFile(fd, tempPath);
+        throw SnapshotFileException(path, "can't resize snapshot file");
+    }
+
+    void* mapping = ::mmap(nullptr, header.fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(mapping == MAP_FAILED)
+    {
+        removeFile(fd, tempPath);
+        throw SnapshotFileException(path, "can't map snapshot file");
+    }
+
+    char* file = static_cast<char*>(mapping);
+    SnapshotAccountEntry* entries = section<SnapshotAccountEntry>(file, header.accountsOffset);
+    SnapshotIndexSlot* index = section<SnapshotIndexSlot>(file, header.indexOffset);
+    unsigned int* txNos = section<unsigned int>(file, header.txNosOffset);
+    double* amounts = section<double>(file, header.amountsOffset);
+
+    uint64_t entryIndex = 0, firstTransaction = 0;
+    for(const AccountTransactions& account : accounts)
+    {
+        SnapshotAccountEntry& entry = entries[entryIndex++];
+        entry.accNo = account.accNo;
+        entry.firstTransaction = firstTransaction;
+        entry.transactionsCount = account.txNos.size();
+        entry.averageAmount = account.stats.average;
+
+        uint64_t slot = account.accNo.hash() & (header.indexCapacity - 1);
+        while(index[slot] != 0)
+            slot = (slot + 1) & (header.indexCapacity - 1);
+        index[slot] = static_cast<SnapshotIndexSlot>(entryIndex);
+
+        std::copy(account.txNos.begin(), account.txNos.end(), txNos + firstTransaction);
+        std::copy(account.amounts.begin(), account.amounts.end(), amounts + firstTransaction);
+        firstTransaction += account.txNos.size();
+    }
+
+    header.dataChecksum = snapshotChecksum(file + sizeof(SnapshotFileHeader), header.fileSize - sizeof(SnapshotFileHeader));
+    header.headerChecksum = snapshotChecksum(&header, offsetof(SnapshotFileHeader, headerChecksum));
+    std::memcpy(file, &header, sizeof(header));
+
+    bool written = ::msync(mapping, header.fileSize, MS_SYNC) == 0;
+    ::munmap(mapping, header.fileSize);
+
+    if(!written || ::close(fd) != 0 || ::rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        removeFile(-1, tempPath);
+        throw SnapshotFileException(path, "can't write snapshot file");
+    }
+}
+
+//[complexity: O(n)]
+uint64_t snapshotChecksum(const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t lanes[4] = { prime1, prime2, 0, prime1 ^ prime2 };
+    size_t i = 0;
+
+    for(; i + 32 <= size; i += 32)
+    {
+        uint64_t words[4];
+        std::memcpy(words, bytes + i, sizeof(words));
+
+        for(size_t lane = 0; lane < 4; ++lane)
+            lanes[lane] = round(lanes[lane], words[lane]);
+    }
+
+    uint64_t checksum = rotate(lanes[0], 1) + rotate(lanes[1], 7) + rotate(lanes[2], 12) + rotate(lanes[3], 18);
+    checksum = round(checksum, static_cast<uint64_t>(size));
+
+    for(; i < size; ++i)
+        checksum = round(checksum, bytes[i]);
+
+    checksum ^= checksum >> 33;
+    checksum *= prime2;
+    checksum ^= checksum >> 29;
+
+    return checksum;
+}
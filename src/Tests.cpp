@@ -1,6 +1,19 @@
 #include <gtest/gtest.h>
 #include <limits>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
 #include "TransactionStore.h"
+#include "MappedTransactionStore.h"
+#include "CsvTransactionsReader.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <system_error>
+#include <cmath>
+#include <random>
+#include <algorithm>
 
 static std::vector<Transaction> transactionsSet1 =
         {
@@ -159,3 +172,1407 @@ TEST(txTests, wrongAccountNumbers)
 
     EXPECT_ANY_THROW(db->setTransactions(transactionsSetTemp));
 }
+
+TEST(txTests, duplicatedTransactions)
+{
+    std::unique_ptr<Database> db = std::make_unique<TransactionStore>();
+    db->setTransactions(transactionsSet2);
+
+    auto trans = db->findTransaction("35200442300000123", 352);
+    EXPECT_EQ(324212, static_cast<int>(trans.amount * 100.0 + 0.5));
+
+    auto t = db->findTransactions("35200442300000123");
+    EXPECT_EQ(2, t.size());
+    EXPECT_EQ(322, t[0].txNo);
+    EXPECT_EQ(352, t[1].txNo);
+}
+
+TEST(txTests, parallelLoading)
+{
+    TransactionStore serialDb;
+    TransactionStore parallelDb(4);
+
+    for(const auto& transactionsSet : { transactionsSet1, transactionsSet2 })
+    {
+        serialDb.setTransactions(transactionsSet);
+        parallelDb.setTransactions(transactionsSet);
+
+        for(const auto& trans : transactionsSet)
+        {
+            auto expected = serialDb.findTransactions(trans.accNo);
+            auto t = parallelDb.findTransactions(trans.accNo);
+
+            ASSERT_EQ(expected.size(), t.size());
+            for(size_t i = 0; i < t.size(); ++i)
+            {
+                EXPECT_EQ(expected[i].txNo, t[i].txNo);
+                EXPECT_EQ(expected[i].amount, t[i].amount);
+            }
+
+            EXPECT_EQ(serialDb.calculateAverageAmount(trans.accNo), parallelDb.calculateAverageAmount(trans.accNo));
+        }
+    }
+
+    auto wrongTransactions = transactionsSet1;
+    wrongTransactions[5].accNo = "dsdf32525 435345#$6";
+    wrongTransactions[9].accNo = "$23^4m*fs@!455";
+
+    try
+    {
+        parallelDb.setTransactions(wrongTransactions);
+        FAIL();
+    }
+    catch(const AccountException& e)
+    {
+        EXPECT_EQ(wrongTransactions[5].accNo, e.accNo);
+    }
+}
+
+TEST(txTests, findTransactionsView)
+{
+    TransactionStore db;
+    db.setTransactions(transactionsSet1);
+
+    auto view = db.findTransactionsView("7230600000000200006669");
+    auto t = db.findTransactions("7230600000000200006669");
+
+    ASSERT_EQ(6, view.size());
+    ASSERT_EQ(t.size(), view.size());
+    EXPECT_EQ(7234, view.front().txNo);
+    EXPECT_EQ(7239, view.back().txNo);
+
+    size_t i = 0;
+    for(auto trans : view)
+    {
+        EXPECT_EQ(t[i].txNo, trans.txNo);
+        EXPECT_EQ(t[i].amount, trans.amount);
+        ++i;
+    }
+
+    //iterators don't refer to the view, so they outlive temporary views
+    auto it = db.findTransactionsView("7230600000000200006669").begin();
+    EXPECT_EQ(7234, it->txNo);
+    EXPECT_EQ(7236.00, (it + 2)->amount);
+    EXPECT_EQ(7239, it[5].txNo);
+
+    auto found = std::lower_bound(view.begin(), view.end(), 7237u, [](const TransactionRef& trans, unsigned int txNo){ return trans.txNo < txNo; });
+    EXPECT_EQ(3, found - view.begin());
+    EXPECT_EQ(&view.accountNumber(), &found->accNo);
+
+    EXPECT_ANY_THROW(db.findTransactionsView("35923AFFA00035"));
+}
+
+TEST(txTests, storeStats)
+{
+    TransactionStore db;
+    db.setTransactions(transactionsSet1);
+
+    StoreStats stats = db.getStats();
+
+    EXPECT_EQ(6, stats.accountsCount);
+    EXPECT_EQ(14, stats.transactionsCount);
+    EXPECT_GE(stats.memoryUsage, stats.transactionsCount * (sizeof(unsigned int) + sizeof(double)));
+}
+
+TEST(txTests, appendTransactions)
+{
+    TransactionStore db;
+    db.setTransactions(transactionsSet1);
+
+    std::vector<Transaction> batch =
+        {
+                {"7230600000000200006669",     7240, 7240.00},
+                {"7230600000000200006669",     7236, 1.00},
+                {"7230600000000200006669",     7233, 7233.00},
+                {"7230600000000200006669",     7233, 2.00},
+                {"9008420017418290055",        1,    -28.00},
+        };
+
+    db.appendTransactions(batch);
+
+    auto t = db.findTransactions("7230600000000200006669");
+    ASSERT_EQ(8, t.size());
+    EXPECT_EQ(7233, t[0].txNo);
+    EXPECT_EQ(7240, t[7].txNo);
+    EXPECT_EQ(7233.00, db.findTransaction("7230600000000200006669", 7233).amount);
+    EXPECT_EQ(7236.00, db.findTransaction("7230600000000200006669", 7236).amount);
+    EXPECT_DOUBLE_EQ(7236.5, db.calculateAverageAmount("7230600000000200006669"));
+
+    EXPECT_EQ(-28.00, db.calculateAverageAmount("9008420017418290055"));
+
+    std::vector<Transaction> wrongBatch = { {"9008420017418290055", 2, 9.00}, {"$23^4m*fs@!455", 0, 0} };
+    EXPECT_ANY_THROW(db.appendTransactions(wrongBatch));
+    EXPECT_EQ(1, db.findTransactions("9008420017418290055").size());
+}
+
+TEST(txTests, appendTransactionsLimits)
+{
+    TransactionStore db;
+    db.setTransactions(transactionsSet2);
+
+    std::vector<Transaction> batch =
+        {
+                {"882346125300012378005",      446,  std::numeric_limits<double>::max()/1.5},
+                {"882346125300012378005",      833,  std::numeric_limits<double>::max()/1.5},
+                {"882346125300012378005",      55,   std::numeric_limits<double>::max()/3.0},
+                {"882346125300012378005",      498,  std::numeric_limits<double>::max()/3.0},
+        };
+
+    db.appendTransactions(batch);
+
+    EXPECT_DOUBLE_EQ(std::numeric_limits<double>::max()/2.0, db.calculateAverageAmount("882346125300012378005"));
+}
+
+TEST(txTests, averageAmountPrecision)
+{
+    TransactionStore db;
+    std::vector<Transaction> transactions =
+        {
+                {"35200442300000123",          1,    1.0e16},
+                {"35200442300000123",          2,    1.00},
+                {"35200442300000123",          3,    -1.0e16},
+        };
+
+    db.setTransactions(transactions);
+
+    EXPECT_DOUBLE_EQ(1.0 / 3.0, db.calculateAverageAmount("35200442300000123"));
+}
+
+TEST(txTests, amountAggregate)
+{
+    std::vector<double> amounts = { std::numeric_limits<double>::max()/1.5, -12.5, std::numeric_limits<double>::max()/3.0, 
+        std::numeric_limits<double>::max()/1.5, 0.01, std::numeric_limits<double>::max()/3.0, 12.49 };
+
+    AmountAggregate batchAggregate, singleAggregate;
+    batchAggregate.add(amounts.data(), amounts.size());
+
+    for(double amount : amounts)
+        singleAggregate.add(amount);
+
+    EXPECT_EQ(amounts.size(), batchAggregate.count);
+    EXPECT_DOUBLE_EQ(std::numeric_limits<double>::max()/3.5, batchAggregate.average());
+    EXPECT_DOUBLE_EQ(batchAggregate.average(), singleAggregate.average());
+}
+
+TEST(txTests, accountNumberValidator)
+{
+    //every character on every position of account numbers with all lengths
+    for(size_t length = 1; length <= 32; ++length)
+    {
+        for(int c = 0; c < 256; ++c)
+        {
+            std::string accNo(length, 'a');
+            accNo[(c * 7) % length] = static_cast<char>(c);
+
+            EXPECT_EQ(isAccountNumberValidScalar(accNo.data(), accNo.size()), isAccountNumberValid(accNo)) << length << " " << c;
+        }
+    }
+
+    EXPECT_FALSE(isAccountNumberValid(""));
+    EXPECT_FALSE(isAccountNumberValid("5342374239DFSD003248dfsf6385MM01G"));
+    EXPECT_TRUE(isAccountNumberValid("34600034880023477100324124340001"));
+    EXPECT_TRUE(isAccountNumberValid("azAZ09"));
+    EXPECT_FALSE(isAccountNumberValid("az@Z09"));
+    EXPECT_FALSE(isAccountNumberValid(std::string("az\0Z09", 6)));
+}
+
+TEST(txTests, findInvalidAccountNumbers)
+{
+    std::vector<Transaction> transactions = transactionsSet1;
+    transactions[3].accNo = "";
+    transactions[7].accNo = "FA42350 0239 SD342";
+    transactions[16].accNo = "5342374239DFSD003248dfsf6385MM01G";
+
+    std::vector<size_t> invalid = findInvalidAccountNumbers(transactions);
+
+    ASSERT_EQ(3, invalid.size());
+    EXPECT_EQ(3, invalid[0]);
+    EXPECT_EQ(7, invalid[1]);
+    EXPECT_EQ(16, invalid[2]);
+
+    EXPECT_TRUE(findInvalidAccountNumbers(transactionsSet2).empty());
+}
+
+TEST(txTests, accountKey)
+{
+    AccountKey key("7230600000000200006669"), sameKey(std::string("7230600000000200006669")), otherKey("7230600000000200006668");
+
+    EXPECT_EQ(22, key.length());
+    EXPECT_EQ("7230600000000200006669", key.toString());
+    EXPECT_TRUE(key == sameKey);
+    EXPECT_EQ(key.hash(), sameKey.hash());
+    EXPECT_TRUE(key != otherKey);
+    EXPECT_NE(key.hash(), otherKey.hash());
+
+    AccountKey longKey("34600034880023477100324124340001");
+    EXPECT_EQ(32, longKey.length());
+    EXPECT_EQ("34600034880023477100324124340001", longKey.toString());
+
+    EXPECT_FALSE(key.assign("5342374239DFSD003248dfsf6385MM01G", 33));
+    EXPECT_FALSE(key.assign("7230600000000200006669\0", 23));
+
+    TransactionStore db;
+    db.setTransactions(transactionsSet1);
+    EXPECT_ANY_THROW(db.findTransactions(std::string("7230600000000200006669\0", 23)));
+    EXPECT_ANY_THROW(db.findTransactions("5342374239DFSD003248dfsf6385MM01G"));
+}
+
+TEST(txTests, flatAccountMap)
+{
+    FlatAccountMap<AccountTransactions> accounts;
+
+    for(int i = 0; i < 10000; ++i)
+        accounts.emplace(AccountKey(std::to_string(i))).txNos.push_back(i);
+
+    EXPECT_EQ(10000, accounts.size());
+    EXPECT_EQ(&accounts.emplace(AccountKey("5000")), accounts.find(AccountKey("5000")));
+    EXPECT_EQ(10000, accounts.size());
+
+    for(int i = 0; i < 10000; ++i)
+    {
+        const AccountTransactions* account = accounts.find(AccountKey(std::to_string(i)));
+
+        ASSERT_NE(nullptr, account);
+        EXPECT_EQ(i, account->txNos[0]);
+        EXPECT_EQ(nullptr, accounts.find(AccountKey("A" + std::to_string(i))));
+    }
+
+    //copy shares records until one of the maps changes them
+    FlatAccountMap<AccountTransactions> copy(accounts);
+    const FlatAccountMap<AccountTransactions>& constAccounts = accounts;
+    const FlatAccountMap<AccountTransactions>& constCopy = copy;
+    EXPECT_EQ(constAccounts.find(AccountKey("5000")), constCopy.find(AccountKey("5000")));
+
+    copy.find(AccountKey("5000"))->txNos.push_back(1);
+    copy.emplace(AccountKey("10000")).txNos.push_back(10000);
+    EXPECT_NE(constAccounts.find(AccountKey("5000")), constCopy.find(AccountKey("5000")));
+    EXPECT_EQ(constAccounts.find(AccountKey("6000")), constCopy.find(AccountKey("6000")));
+    EXPECT_EQ(1, constAccounts.find(AccountKey("5000"))->txNos.size());
+    EXPECT_EQ(2, constCopy.find(AccountKey("5000"))->txNos.size());
+    EXPECT_EQ(nullptr, constAccounts.find(AccountKey("10000")));
+    EXPECT_EQ(10000, accounts.size());
+    EXPECT_EQ(10001, copy.size());
+
+    accounts.emplace(AccountKey("10001"));
+    EXPECT_EQ(nullptr, constCopy.find(AccountKey("10001")));
+    EXPECT_EQ(10000, constCopy.find(AccountKey("10000"))->txNos[0]);
+
+    accounts.clear();
+    EXPECT_EQ(nullptr, constAccounts.find(AccountKey("5000")));
+    EXPECT_EQ(5000, constCopy.find(AccountKey("5000"))->txNos[0]);
+}
+
+TEST(txTests, concurrentReadsDuringAppends)
+{
+    TransactionStore db;
+    db.setConcurrentReads(true);
+    db.setArenaColumns(true);
+    db.setFilterFalsePositiveRate(0.01);
+    db.setTransactions(transactionsSet1);
+
+    std::atomic<bool> finished(false);
+    std::atomic<int> wrongResults(0);
+
+    //accounts untouched by appends keep their data, the appended one only grows
+    std::vector<std::thread> readers;
+    for(int i = 0; i < 3; ++i)
+    {
+        readers.emplace_back([&](){
+            while(!finished.load())
+            {
+                TransactionStore::ReadGuard guard;
+                auto view = db.findTransactionsView("7230600000000200006669");
+                if(view.size() != 6 || view.front().txNo != 7234 || view.back().amount != 7239.00) ++wrongResults;
+
+                auto appended = db.findTransactionsView("35102049000000990200522828");
+                if(appended.size() < 2 || (appended.front().txNo != 1 && appended.front().txNo != 3515) || appended.back().txNo != 3517) ++wrongResults;
+            }
+        });
+    }
+
+    for(unsigned int txNo = 1; txNo < 200; ++txNo)
+        db.appendTransactions({{"35102049000000990200522828", txNo, 1.0}, {std::to_string(100000 + txNo), txNo, 1.0}});
+
+    finished = true;
+    for(std::thread& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(0, wrongResults.load());
+    EXPECT_EQ(201, db.findTransactionsView("35102049000000990200522828").size());
+    EXPECT_EQ(7236.50, db.calculateAverageAmount("7230600000000200006669"));
+    EXPECT_EQ(1.0, db.calculateAverageAmount("100199"));
+}
+
+TEST(txTests, concurrentReadsDuringReload)
+{
+    TransactionStore db;
+    db.setConcurrentReads(true);
+    db.setTransactions(transactionsSet1);
+
+    std::atomic<bool> finished(false);
+    std::atomic<int> wrongResults(0);
+
+    std::vector<std::thread> readers;
+    for(int i = 0; i < 3; ++i)
+    {
+        readers.emplace_back([&](){
+            while(!finished.load())
+            {
+                int avg = static_cast<int>(db.calculateAverageAmount("7230600000000200006669") * 100.0);
+                if(avg != 723650 && avg != 14965272) ++wrongResults;
+
+                TransactionStore::ReadGuard guard;
+                auto view = db.findTransactionsView("7230600000000200006669");
+                if(view.size() != 6 && view.size() != 3) ++wrongResults;
+                if(view.front().txNo != 7234 && view.front().txNo != 241) ++wrongResults;
+            }
+        });
+    }
+
+    for(int i = 0; i < 200; ++i)
+    {
+        db.setTransactions((i % 2 == 0) ? transactionsSet2 : transactionsSet1);
+        db.appendTransactions({ {"9008420017418290055", 3, 1.00} });
+    }
+
+    finished.store(true);
+    for(auto& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(0, wrongResults.load());
+    EXPECT_EQ(1, db.findTransactions("9008420017418290055").size());
+}
+
+TEST(txTests, snapshotFileRoundTrip)
+{
+    const std::string path = ::testing::TempDir() + "txstore_round_trip.snapshot";
+
+    TransactionStore db;
+    db.setTransactions(transactionsSet2);
+    db.saveSnapshot(path);
+
+    MappedTransactionStore mapped(path, true);
+
+    EXPECT_EQ(db.getStats().accountsCount, mapped.accountsCount());
+    EXPECT_EQ(db.getStats().transactionsCount, mapped.transactionsCount());
+
+    for(const char* accNo : { "7230600000000200006669", "35200442300000123", "9008420017418290055", "882346125300012378005", "34600034880023477100324124340001" })
+    {
+        EXPECT_EQ(db.calculateAverageAmount(accNo), mapped.calculateAverageAmount(accNo));
+
+        auto expected = db.findTransactions(accNo);
+        auto found = mapped.findTransactions(accNo);
+        ASSERT_EQ(expected.size(), found.size());
+
+        for(size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(expected[i].accNo, found[i].accNo);
+            EXPECT_EQ(expected[i].txNo, found[i].txNo);
+            EXPECT_EQ(expected[i].amount, found[i].amount);
+        }
+    }
+
+    EXPECT_EQ(3242.12, mapped.findTransaction("35200442300000123", 352).amount);
+    EXPECT_THROW(mapped.findTransaction("35200442300000123", 353), TransactionException);
+    EXPECT_THROW(mapped.findTransaction("35200442300000123", -1), TransactionException);
+    EXPECT_THROW(mapped.findTransactions("35102049000000990200522828"), AccountException);
+    EXPECT_THROW(mapped.calculateAverageAmount("invalid!"), AccountException);
+    EXPECT_THROW(mapped.setTransactions(transactionsSet1), SnapshotFileException);
+
+    std::remove(path.c_str());
+}
+
+TEST(txTests, snapshotFileCorruption)
+{
+    const std::string path = ::testing::TempDir() + "txstore_corrupted.snapshot";
+
+    TransactionStore db;
+    db.setTransactions(transactionsSet1);
+
+    auto corrupt = [&](size_t offset){
+        db.saveSnapshot(path);
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(offset);
+        char byte = static_cast<char>(file.get());
+        file.seekp(offset);
+        file.put(static_cast<char>(byte ^ 0x01));
+    };
+
+    //version field
+    corrupt(8);
+    EXPECT_THROW(MappedTransactionStore store(path), SnapshotFileException);
+
+    //header checksum covers all the offsets
+    corrupt(offsetof(SnapshotFileHeader, txNosOffset));
+    EXPECT_THROW(MappedTransactionStore store(path), SnapshotFileException);
+
+    //data is verified only on request
+    corrupt(sizeof(SnapshotFileHeader) + 1);
+    EXPECT_NO_THROW(MappedTransactionStore store(path));
+    EXPECT_THROW(MappedTransactionStore store(path, true), SnapshotFileException);
+
+    //values used by lookups are verified even without data checksum
+    SnapshotFileHeader header;
+    std::ifstream(path, std::ios::binary).read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    auto overwrite = [&](size_t offset, const void* data, size_t size){
+        db.saveSnapshot(path);
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offset);
+        file.write(static_cast<const char*>(data), size);
+    };
+
+    const SnapshotIndexSlot badSlot = static_cast<SnapshotIndexSlot>(header.accountsCount + 1);
+    overwrite(header.indexOffset, &badSlot, sizeof(badSlot));
+    EXPECT_THROW(MappedTransactionStore store(path), SnapshotFileException);
+
+    const std::vector<SnapshotIndexSlot> fullIndex(header.indexCapacity, 1);
+    overwrite(header.indexOffset, fullIndex.data(), fullIndex.size() * sizeof(SnapshotIndexSlot));
+    EXPECT_THROW(MappedTransactionStore store(path), SnapshotFileException);
+
+    const uint64_t badFirst = header.transactionsCount;
+    overwrite(header.accountsOffset + offsetof(SnapshotAccountEntry, firstTransaction), &badFirst, sizeof(badFirst));
+    EXPECT_THROW(MappedTransactionStore store(path), SnapshotFileException);
+
+    const uint64_t badCount = ~uint64_t(0);
+    overwrite(header.accountsOffset + offsetof(SnapshotAccountEntry, transactionsCount), &badCount, sizeof(badCount));
+    EXPECT_THROW(MappedTransactionStore store(path), SnapshotFileException);
+
+    db.saveSnapshot(path);
+    EXPECT_NO_THROW(MappedTransactionStore store(path));
+
+    std::remove(path.c_str());
+    EXPECT_THROW(MappedTransactionStore store(path), SnapshotFileException);
+}
+
+static std::string writeTextFile(const std::string& name, const std::string& text)
+{
+    const std::string path = ::testing::TempDir() + name;
+    std::ofstream(path, std::ios::binary) << text;
+    return path;
+}
+
+TEST(txTests, parseAmount)
+{
+    auto parse = [](const std::string& text){
+        double amount = 0.0;
+        if(!parseAmount(text.data(), text.data() + text.size(), amount)) throw std::invalid_argument(text);
+        return amount;
+    };
+
+    EXPECT_EQ(0.10, parse("0.10"));
+    EXPECT_EQ(-2512.54, parse("-2512.54"));
+    EXPECT_EQ(451235.21, parse("451235.21"));
+    EXPECT_EQ(12.5, parse("+12.5"));
+    EXPECT_EQ(7.0, parse("7"));
+    EXPECT_EQ(0.125, parse("0.125"));
+    EXPECT_EQ(1e300, parse("1e300"));
+    EXPECT_EQ(9999999999999.99, parse("9999999999999.99"));
+    EXPECT_EQ(123456789012345678.25, parse("123456789012345678.25"));
+
+    for(const char* wrong : { "", "-", ".", "12a", "1.2.3", "inf", "nan", "1e999" })
+        EXPECT_THROW(parse(wrong), std::invalid_argument) << wrong;
+
+    unsigned int txNo = 0;
+    std::string max = "4294967295", tooBig = "4294967296";
+    EXPECT_TRUE(parseTxNo(max.data(), max.data() + max.size(), txNo));
+    EXPECT_EQ(4294967295u, txNo);
+    EXPECT_FALSE(parseTxNo(tooBig.data(), tooBig.data() + tooBig.size(), txNo));
+}
+
+TEST(txTests, csvTransactionsReader)
+{
+    const std::string path = writeTextFile("txstore_reader.csv", "7230600000000200006669,355,235.50\r\n\n35200442300000123,352,3242.12\n9008420017418290055,0,-28");
+
+    //buffer smaller than the data, so lines are split between chunks
+    int fd = ::open(path.c_str(), O_RDONLY);
+    CsvTransactionsReader reader(fd, 40);
+    TransactionRecord record;
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ("7230600000000200006669", std::string(record.accNo, record.accNoLength));
+    EXPECT_EQ(355, record.txNo);
+    EXPECT_EQ(235.50, record.amount);
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ("35200442300000123", std::string(record.accNo, record.accNoLength));
+    EXPECT_EQ(3, reader.lineNumber());
+
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(0, record.txNo);
+    EXPECT_EQ(-28.0, record.amount);
+
+    EXPECT_FALSE(reader.next(record));
+    ::close(fd);
+
+    std::remove(path.c_str());
+}
+
+TEST(txTests, loadTransactionsFromFile)
+{
+    std::string text;
+    for(const Transaction& trans : transactionsSet1)
+        text += trans.accNo + "," + std::to_string(trans.txNo) + "," + std::to_string(trans.amount) + "\n";
+
+    const std::string path = writeTextFile("txstore_load.csv", text);
+
+    TransactionStore expected, db;
+    expected.setTransactions(transactionsSet1);
+    db.loadTransactionsFromFile(path);
+
+    EXPECT_EQ(expected.getStats().accountsCount, db.getStats().accountsCount);
+    EXPECT_EQ(expected.getStats().transactionsCount, db.getStats().transactionsCount);
+    EXPECT_EQ(expected.calculateAverageAmount("7230600000000200006669"), db.calculateAverageAmount("7230600000000200006669"));
+    EXPECT_EQ(501.00, db.findTransaction("50102055581111101998100048", 501).amount);
+
+    writeTextFile("txstore_load.csv", "35200442300000123,352,3242.12\n35200442300000123,352\n");
+    try
+    {
+        db.loadTransactionsFromFile(path);
+        FAIL();
+    }
+    catch(const TransactionsFormatException& e)
+    {
+        EXPECT_EQ(2, e.line);
+    }
+
+    writeTextFile("txstore_load.csv", "35200442300000123,352,3242.12\n35200442-300000123,352,1.00\n");
+    EXPECT_THROW(db.loadTransactionsFromFile(path), AccountException);
+
+    std::remove(path.c_str());
+    try
+    {
+        db.loadTransactionsFromFile(path);
+        FAIL();
+    }
+    catch(const std::system_error& e)
+    {
+        EXPECT_EQ(std::errc::no_such_file_or_directory, e.code());
+    }
+
+    //reading directory fails after it's opened
+    EXPECT_THROW(db.loadTransactionsFromFile(::testing::TempDir()), std::system_error);
+}
+
+TEST(txTests, failedLoading)
+{
+    const std::string path = writeTextFile("txstore_failed.csv", "35200442300000123,352,3242.12\n35200442300000123,352\n");
+    const std::vector<Transaction> invalid = { {"35200442300000123", 1, 1.00}, {"invalid!", 2, 2.00} };
+
+    //without concurrent reads old data is released before loading
+    TransactionStore db;
+    db.setTransactions(transactionsSet1);
+    EXPECT_THROW(db.setTransactions(invalid), AccountException);
+    EXPECT_EQ(0, db.getStats().transactionsCount);
+    EXPECT_THROW(db.findTransaction("50102055581111101998100048", 501), AccountException);
+
+    db.setTransactions(transactionsSet1);
+    EXPECT_THROW(db.loadTransactionsFromFile(path), TransactionsFormatException);
+    EXPECT_EQ(0, db.getStats().transactionsCount);
+
+    //file which can't be opened doesn't touch loaded data
+    db.setTransactions(transactionsSet1);
+    EXPECT_THROW(db.loadTransactionsFromFile(path + ".missing"), std::system_error);
+    EXPECT_EQ(501.00, db.findTransaction("50102055581111101998100048", 501).amount);
+
+    //with concurrent reads new data is built aside, so old one stays published
+    TransactionStore concurrent;
+    concurrent.setConcurrentReads(true);
+    concurrent.setTransactions(transactionsSet1);
+    const size_t transactionsCount = concurrent.getStats().transactionsCount;
+
+    EXPECT_THROW(concurrent.setTransactions(invalid), AccountException);
+    EXPECT_EQ(transactionsCount, concurrent.getStats().transactionsCount);
+
+    EXPECT_THROW(concurrent.loadTransactionsFromFile(path), TransactionsFormatException);
+    EXPECT_EQ(transactionsCount, concurrent.getStats().transactionsCount);
+    EXPECT_EQ(501.00, concurrent.findTransaction("50102055581111101998100048", 501).amount);
+
+    std::remove(path.c_str());
+}
+
+TEST(txTests, batchLookups)
+{
+    TransactionStore db;
+    db.setTransactions(transactionsSet2);
+
+    //more queries than one prefetched block
+    std::vector<TransactionQuery> queries;
+    std::vector<std::string> accNos;
+    for(int i = 0; i < 10; ++i)
+    {
+        queries.push_back({ "35200442300000123", 352 });
+        queries.push_back({ "9008420017418290055", 1 });
+        queries.push_back({ "9008420017418290055", 7 });
+        queries.push_back({ "9008420017418290055", -1 });
+        queries.push_back({ "35102049000000990200522828", 3517 });
+        queries.push_back({ "invalid!", 0 });
+
+        accNos.push_back("7230600000000200006669");
+        accNos.push_back("35102049000000990200522828");
+        accNos.push_back("");
+    }
+
+    auto transactions = db.findTransactionBatch(queries);
+    ASSERT_EQ(queries.size(), transactions.size());
+
+    for(size_t i = 0; i < queries.size(); i += 6)
+    {
+        EXPECT_EQ(LookupStatus::Found, transactions[i].status);
+        EXPECT_EQ(3242.12, transactions[i].transaction.amount);
+        EXPECT_EQ("35200442300000123", transactions[i].transaction.accNo);
+        EXPECT_EQ(LookupStatus::Found, transactions[i + 1].status);
+        EXPECT_EQ(-28.00, transactions[i + 1].transaction.amount);
+        EXPECT_EQ(LookupStatus::TransactionNotFound, transactions[i + 2].status);
+        EXPECT_EQ(LookupStatus::TransactionNotFound, transactions[i + 3].status);
+        EXPECT_EQ(LookupStatus::AccountNotFound, transactions[i + 4].status);
+        EXPECT_EQ(LookupStatus::AccountNotFound, transactions[i + 5].status);
+    }
+
+    auto averages = db.calculateAverageAmountBatch(accNos);
+    ASSERT_EQ(accNos.size(), averages.size());
+
+    for(size_t i = 0; i < accNos.size(); i += 3)
+    {
+        EXPECT_EQ(LookupStatus::Found, averages[i].status);
+        EXPECT_EQ(db.calculateAverageAmount(accNos[i]), averages[i].averageAmount);
+        EXPECT_EQ(LookupStatus::AccountNotFound, averages[i + 1].status);
+        EXPECT_EQ(LookupStatus::AccountNotFound, averages[i + 2].status);
+    }
+
+    EXPECT_TRUE(TransactionStore().calculateAverageAmountBatch(accNos).size() == accNos.size());
+}
+
+TEST(txTests, tryLookups)
+{
+    TransactionStore db;
+    db.setTransactions(transactionsSet2);
+
+    TransactionLookup transaction = db.tryFindTransaction("9008420017418290055", 2);
+    EXPECT_EQ(LookupStatus::Found, transaction.status);
+    EXPECT_EQ(9.00, transaction.transaction.amount);
+    EXPECT_EQ("9008420017418290055", transaction.transaction.accNo);
+
+    EXPECT_EQ(LookupStatus::TransactionNotFound, db.tryFindTransaction("9008420017418290055", 3).status);
+    EXPECT_EQ(LookupStatus::TransactionNotFound, db.tryFindTransaction("9008420017418290055", -3).status);
+    EXPECT_EQ(LookupStatus::AccountNotFound, db.tryFindTransaction("35102049000000990200522828", 3517).status);
+    EXPECT_EQ(LookupStatus::AccountNotFound, db.tryFindTransaction("", 0).status);
+
+    TransactionsLookup transactions = db.tryFindTransactionsView("35200442300000123");
+    EXPECT_EQ(LookupStatus::Found, transactions.status);
+    EXPECT_EQ(2, transactions.transactions.size());
+
+    transactions = db.tryFindTransactionsView("35200442300000124");
+    EXPECT_EQ(LookupStatus::AccountNotFound, transactions.status);
+    EXPECT_TRUE(transactions.transactions.empty());
+    EXPECT_TRUE(transactions.transactions.begin() == transactions.transactions.end());
+
+    AverageLookup average = db.tryCalculateAverageAmount("9008420017418290055");
+    EXPECT_EQ(LookupStatus::Found, average.status);
+    EXPECT_EQ(db.calculateAverageAmount("9008420017418290055"), average.averageAmount);
+    EXPECT_EQ(LookupStatus::AccountNotFound, db.tryCalculateAverageAmount("invalid!").status);
+
+    //throwing methods report the same misses
+    EXPECT_THROW(db.findTransaction("9008420017418290055", 3), TransactionException);
+    EXPECT_THROW(db.findTransaction("35102049000000990200522828", -1), TransactionException);
+    EXPECT_THROW(db.findTransaction("35102049000000990200522828", 3517), AccountException);
+    EXPECT_THROW(db.findTransactionsView("35200442300000124"), AccountException);
+    EXPECT_THROW(db.calculateAverageAmount("invalid!"), AccountException);
+}
+
+TEST(txTests, blockedBloomFilter)
+{
+    BlockedBloomFilter filter;
+    EXPECT_TRUE(filter.mayContain(12345));
+
+    filter.build(10000, 0.01);
+    for(uint64_t i = 0; i < 10000; ++i)
+        filter.add(AccountKey(std::to_string(i)).hash());
+
+    for(uint64_t i = 0; i < 10000; ++i)
+        EXPECT_TRUE(filter.mayContain(AccountKey(std::to_string(i)).hash()));
+
+    BlockedBloomFilter copy(filter);
+    size_t falsePositives = 0;
+    for(uint64_t i = 10000; i < 110000; ++i)
+    {
+        bool found = filter.mayContain(AccountKey(std::to_string(i)).hash());
+        EXPECT_EQ(found, copy.mayContain(AccountKey(std::to_string(i)).hash()));
+        falsePositives += found;
+    }
+
+    EXPECT_LT(falsePositives, 2000);
+    EXPECT_GT(filter.memoryUsage(), 10000);
+}
+
+TEST(txTests, lookupFilters)
+{
+    TransactionStore db;
+    EXPECT_THROW(db.setFilterFalsePositiveRate(1.0), std::invalid_argument);
+
+    db.setFilterFalsePositiveRate(0.01);
+    db.setTransactions(transactionsSet2);
+
+    StoreStats stats = db.getStats();
+    EXPECT_GT(stats.filtersMemoryUsage, 0);
+    EXPECT_GE(stats.memoryUsage, stats.filtersMemoryUsage);
+
+    for(const Transaction& trans : transactionsSet2)
+        EXPECT_EQ(LookupStatus::Found, db.tryFindTransaction(trans.accNo, trans.txNo).status);
+
+    EXPECT_EQ(LookupStatus::TransactionNotFound, db.tryFindTransaction("9008420017418290055", 3).status);
+    EXPECT_EQ(LookupStatus::AccountNotFound, db.tryFindTransaction("35102049000000990200522828", 3517).status);
+    EXPECT_EQ(LookupStatus::AccountNotFound, db.calculateAverageAmountBatch({ "35102049000000990200522828" })[0].status);
+
+    //appended transactions are added to filters, also in concurrent mode where snapshot is copied
+    db.appendTransactions({ {"9008420017418290055", 3, 1.00}, {"35102049000000990200522828", 3517, 3517.00} });
+    db.setConcurrentReads(true);
+    db.appendTransactions({ {"9008420017418290055", 4, 1.00}, {"4830600000000200003900", 4830, 4830.00} });
+
+    EXPECT_EQ(LookupStatus::Found, db.tryFindTransaction("9008420017418290055", 3).status);
+    EXPECT_EQ(LookupStatus::Found, db.tryFindTransaction("9008420017418290055", 4).status);
+    EXPECT_EQ(LookupStatus::Found, db.tryFindTransaction("35102049000000990200522828", 3517).status);
+    EXPECT_EQ(4830.00, db.calculateAverageAmount("4830600000000200003900"));
+
+    //only inserted transactions fill filters, they're rebuilt bigger once appends exceed their capacity
+    db.setTransactions(transactionsSet1);
+    const size_t loadedFiltersMemory = db.getStats().filtersMemoryUsage;
+    for(int i = 0; i < 10; ++i)
+        db.appendTransactions(transactionsSet1);
+    EXPECT_EQ(loadedFiltersMemory, db.getStats().filtersMemoryUsage);
+
+    std::vector<Transaction> newTransactions;
+    for(unsigned int txNo = 1; txNo <= 20; ++txNo)
+        newTransactions.push_back({ "4830600000000200003900", txNo, 1.00 });
+    db.appendTransactions(newTransactions);
+    EXPECT_LT(loadedFiltersMemory, db.getStats().filtersMemoryUsage);
+    EXPECT_EQ(LookupStatus::Found, db.tryFindTransaction("4830600000000200003900", 20).status);
+
+    //filters are dropped on the next load
+    db.setFilterFalsePositiveRate(0.0);
+    db.setTransactions(transactionsSet1);
+    EXPECT_EQ(0, db.getStats().filtersMemoryUsage);
+    EXPECT_EQ(5611.00, db.findTransaction("56102055610000310200008433", 5611).amount);
+}
+
+TEST(txTests, transactionSearchIndex)
+{
+    auto checkIndex = [](const std::vector<unsigned int>& txNos, TransactionSearchIndex::Kind kind){
+        TransactionSearchIndex index;
+        index.build(txNos.data(), txNos.size());
+        EXPECT_EQ(kind, index.getKind());
+
+        for(size_t i = 0; i < txNos.size(); ++i)
+            ASSERT_EQ(i, index.find(txNos.data(), txNos.size(), txNos[i]));
+
+        //values between, before and after all txNos, gtest macros expand to if-else, so they're braced
+        for(size_t i = 0; i + 1 < txNos.size(); ++i)
+        {
+            if(txNos[i] + 1 != txNos[i + 1])
+            {
+                ASSERT_EQ(txNos.size(), index.find(txNos.data(), txNos.size(), txNos[i] + 1));
+            }
+        }
+
+        if(txNos.back() != std::numeric_limits<unsigned int>::max())
+        {
+            EXPECT_EQ(txNos.size(), index.find(txNos.data(), txNos.size(), std::numeric_limits<unsigned int>::max()));
+        }
+
+        if(txNos.front() > 0)
+        {
+            EXPECT_EQ(txNos.size(), index.find(txNos.data(), txNos.size(), 0));
+        }
+    };
+
+    std::vector<unsigned int> small = { 3, 8, 10 }, uniform, clustered;
+
+    for(unsigned int i = 0; i < 100000; ++i)
+        uniform.push_back(i * 7 + (i % 3) + 5);
+
+    //clusters of consecutive numbers with big gaps, count not being a multiple of block size
+    unsigned int txNo = 1;
+    for(unsigned int i = 0; i < 100003; ++i)
+        clustered.push_back(txNo += (i % 100 == 0) ? 1000 + (i * 37) % 5000 : 2);
+
+    checkIndex(small, TransactionSearchIndex::Kind::Binary);
+    checkIndex(uniform, TransactionSearchIndex::Kind::Interpolation);
+    checkIndex(clustered, TransactionSearchIndex::Kind::Eytzinger);
+
+    clustered.resize(1025);
+    checkIndex(clustered, TransactionSearchIndex::Kind::Eytzinger);
+
+    //max txNo equal to tree's padding
+    clustered.back() = std::numeric_limits<unsigned int>::max();
+    checkIndex(clustered, TransactionSearchIndex::Kind::Eytzinger);
+
+    TransactionSearchIndex empty;
+    empty.build(nullptr, 0);
+    EXPECT_EQ(0, empty.find(nullptr, 0, 5));
+}
+
+TEST(txTests, findTransactionLargeAccount)
+{
+    std::vector<Transaction> transactions;
+    for(unsigned int i = 0; i < 5000; ++i)
+        transactions.push_back({ "35200442300000123", (i % 2 == 0) ? i * 3 : i * i, static_cast<double>(i) });
+
+    TransactionStore db;
+    db.setTransactions(transactions);
+
+    for(unsigned int i = 0; i < 5000; ++i)
+        ASSERT_EQ(static_cast<double>(i), db.findTransaction("35200442300000123", static_cast<int>(transactions[i].txNo)).amount);
+
+    EXPECT_EQ(LookupStatus::TransactionNotFound, db.tryFindTransaction("35200442300000123", 4).status);
+
+    //index is rebuilt after append
+    db.appendTransactions({ {"35200442300000123", 4, -1.00} });
+    EXPECT_EQ(-1.00, db.findTransaction("35200442300000123", 4).amount);
+    EXPECT_EQ(4998.00, db.findTransaction("35200442300000123", 4998 * 3).amount);
+}
+
+TEST(txTests, findTransactionsInRange)
+{
+    TransactionStore db;
+    db.setTransactions(transactionsSet1);
+
+    auto view = db.findTransactionsInRange("7230600000000200006669", 7235, 7238);
+    ASSERT_EQ(3, view.size());
+    EXPECT_EQ(7235, view.front().txNo);
+    EXPECT_EQ(7237, view.back().txNo);
+    EXPECT_EQ(7236.00, view[1].amount);
+
+    EXPECT_EQ(6, db.findTransactionsInRange("7230600000000200006669", 0, std::numeric_limits<unsigned int>::max()).size());
+    EXPECT_TRUE(db.findTransactionsInRange("7230600000000200006669", 7238, 7238).empty());
+    EXPECT_TRUE(db.findTransactionsInRange("7230600000000200006669", 7240, 7230).empty());
+    EXPECT_THROW(db.findTransactionsInRange("35200442300000123", 0, 10), AccountException);
+
+    AmountRangeAggregate aggregate = db.calculateRangeAggregate("7230600000000200006669", 7235, 7238);
+    EXPECT_EQ(3, aggregate.count);
+    EXPECT_EQ(7235.00 + 7236.00 + 7237.00, aggregate.sum);
+    EXPECT_EQ(7236.00, aggregate.average);
+    EXPECT_EQ(7235.00, aggregate.minAmount);
+    EXPECT_EQ(7237.00, aggregate.maxAmount);
+
+    aggregate = db.calculateRangeAggregate("7230600000000200006669", 1, 2);
+    EXPECT_EQ(0, aggregate.count);
+    EXPECT_TRUE(std::isnan(aggregate.average));
+}
+
+TEST(txTests, calculateRangeAggregate)
+{
+    //big account, so ranges are aggregated with the tree, amounts close to double's limit
+    std::vector<Transaction> transactions;
+    for(unsigned int i = 0; i < 1000; ++i)
+    {
+        double amount = (i % 7 == 0) ? std::numeric_limits<double>::max() / 3.0 : static_cast<double>((i * 37) % 101) - 50.0;
+        transactions.push_back({ "882346125300012378005", i * 2, amount });
+    }
+
+    TransactionStore db;
+    db.setTransactions(transactions);
+
+    for(unsigned int lo : { 0u, 1u, 30u, 31u, 32u, 250u, 1999u })
+    {
+        for(unsigned int hi : { 5u, 32u, 33u, 64u, 97u, 1000u, 2000u, 5000u })
+        {
+            AmountRangeAggregate aggregate = db.calculateRangeAggregate("882346125300012378005", lo, hi);
+
+            size_t count = 0;
+            double minAmount = std::numeric_limits<double>::infinity(), maxAmount = -minAmount;
+            long double sum = 0.0L;
+            for(const Transaction& trans : transactions)
+            {
+                if(trans.txNo < lo || trans.txNo >= hi) continue;
+
+                ++count;
+                sum += trans.amount;
+                minAmount = std::min(minAmount, trans.amount);
+                maxAmount = std::max(maxAmount, trans.amount);
+            }
+
+            ASSERT_EQ(count, aggregate.count) << lo << " " << hi;
+            if(count == 0) continue;
+
+            EXPECT_EQ(minAmount, aggregate.minAmount);
+            EXPECT_EQ(maxAmount, aggregate.maxAmount);
+            EXPECT_TRUE(std::isfinite(aggregate.average));
+            double average = static_cast<double>(sum / count);
+            EXPECT_NEAR(average, aggregate.average, std::abs(average) * 1e-12 + 1e-12) << lo << " " << hi;
+        }
+    }
+
+    //tree is rebuilt after append
+    db.appendTransactions({ {"882346125300012378005", 1, -1000.00} });
+    EXPECT_EQ(-1000.00, db.calculateRangeAggregate("882346125300012378005", 0, 2000).minAmount);
+    EXPECT_EQ(1001, db.calculateRangeAggregate("882346125300012378005", 0, 2000).count);
+}
+
+TEST(txTests, calculateAverageAmountInRange)
+{
+    TransactionStore db;
+    db.setTransactions(transactionsSet1);
+
+    //small account, range is summed directly
+    EXPECT_DOUBLE_EQ(7236.00, db.calculateAverageAmount("7230600000000200006669", 7235, 7238));
+    EXPECT_EQ(0.0, db.calculateAverageAmount("7230600000000200006669", 1, 2));
+    EXPECT_THROW(db.calculateAverageAmount("35200442300000123", 0, 10), AccountException);
+    EXPECT_EQ(LookupStatus::AccountNotFound, db.tryCalculateAverageAmount("invalid!", 0, 10).status);
+
+    //big account with prefix sums, huge amounts cancel out before a run of cents, which mustn't be lost
+    std::vector<Transaction> transactions;
+    for(unsigned int i = 0; i < 1000; ++i)
+    {
+        double amount = static_cast<double>(i % 10) / 100.0;
+        if(i < 100) amount = (i % 2 == 0) ? std::numeric_limits<double>::max() : -std::numeric_limits<double>::max();
+        transactions.push_back({ "882346125300012378005", i, amount });
+    }
+
+    db.setTransactions(transactions);
+
+    EXPECT_DOUBLE_EQ(std::numeric_limits<double>::max(), db.calculateAverageAmount("882346125300012378005", 0, 1));
+    EXPECT_DOUBLE_EQ(std::numeric_limits<double>::max() / 3.0, db.calculateAverageAmount("882346125300012378005", 96, 99));
+    EXPECT_DOUBLE_EQ(0.045, db.calculateAverageAmount("882346125300012378005", 100, 1000));
+    EXPECT_DOUBLE_EQ(0.045, db.calculateAverageAmount("882346125300012378005", 500, 600));
+    EXPECT_DOUBLE_EQ(0.09, db.calculateAverageAmount("882346125300012378005", 109, 110));
+    EXPECT_DOUBLE_EQ(0.9 * 0.045, db.calculateAverageAmount("882346125300012378005", 0, 1000));
+    EXPECT_DOUBLE_EQ(0.45, db.calculateRangeAggregate("882346125300012378005", 0, 110).sum);
+
+    //prefix sums are rebuilt after append
+    db.appendTransactions({ {"882346125300012378005", 1000, 40.59} });
+    EXPECT_DOUBLE_EQ(0.09, db.calculateAverageAmount("882346125300012378005", 100, 1001));
+    EXPECT_EQ(LookupStatus::Found, db.tryCalculateAverageAmount("882346125300012378005", 100, 1001).status);
+
+    //balanced debits and credits, differences of exact prefixes are exactly 0
+    transactions.clear();
+    for(unsigned int i = 0; i < 4000; ++i)
+        transactions.push_back({ "882346125300012378005", i, (i % 2 == 0) ? 1000.25 : -1000.25 });
+
+    db.setTransactions(transactions);
+    EXPECT_EQ(0.0, db.calculateAverageAmount("882346125300012378005", 1, 3001));
+    EXPECT_EQ(0.0, db.calculateRangeAggregate("882346125300012378005", 17, 3999).sum);
+    EXPECT_EQ(-1000.25, db.calculateRangeAggregate("882346125300012378005", 1, 3000).sum);
+
+    //bits of 2^-60 are lost by prefixes next to 2^60 and 1, range cancelling out below them is summed by blocks
+    transactions.clear();
+    for(unsigned int i = 0; i < 100; ++i)
+        transactions.push_back({ "882346125300012378005", i, 0.0 });
+    transactions[0].amount = 1.0;
+    transactions[16].amount = std::ldexp(1.0, 60);
+    transactions[17].amount = std::ldexp(1.0, -60);
+    transactions[18].amount = -std::ldexp(1.0, 60);
+
+    db.setTransactions(transactions);
+    EXPECT_EQ(std::ldexp(1.0, -60), db.calculateRangeAggregate("882346125300012378005", 16, 32).sum);
+    EXPECT_EQ(std::ldexp(1.0, -60), db.calculateRangeAggregate("882346125300012378005", 1, 100).sum);
+    EXPECT_EQ(1.0, db.calculateRangeAggregate("882346125300012378005", 0, 64).sum);
+}
+
+TEST(txTests, fixedPointAmounts)
+{
+    const double maxAmount = 7036874417766399 / 100.0;
+    int64_t cents = 0;
+
+    EXPECT_TRUE(amountToCents(-2512.54, cents));
+    EXPECT_EQ(-251254, cents);
+    EXPECT_TRUE(amountToCents(0.1, cents));
+    EXPECT_EQ(10, cents);
+    EXPECT_TRUE(amountToCents(-maxAmount, cents));
+    EXPECT_EQ(-7036874417766399, cents);
+    EXPECT_FALSE(amountToCents(1.005, cents));
+    EXPECT_FALSE(amountToCents(maxFixedPointAmount, cents));
+    EXPECT_FALSE(amountToCents(std::numeric_limits<double>::max(), cents));
+    EXPECT_FALSE(amountToCents(std::numeric_limits<double>::quiet_NaN(), cents));
+
+    TransactionStore db, doubleDb;
+    EXPECT_FALSE(db.getFixedPointAmounts());
+    db.setFixedPointAmounts(true);
+
+    db.setTransactions(transactionsSet1);
+    doubleDb.setTransactions(transactionsSet1);
+    EXPECT_EQ(7236.5, db.calculateAverageAmount("7230600000000200006669"));
+    EXPECT_EQ(doubleDb.getStats().memoryUsage + db.getStats().transactionsCount * sizeof(int64_t), db.getStats().memoryUsage);
+    EXPECT_THROW(db.setTransactions(transactionsSet2), AmountException);
+
+    //sum of cents is exact, double sum of 0.1 + 0.2 isn't
+    db.setTransactions({ {"882346125300012378005", 1, 0.1}, {"882346125300012378005", 2, 0.2} });
+    EXPECT_EQ(0.15, db.calculateAverageAmount("882346125300012378005"));
+
+    db.setTransactions({ {"882346125300012378005", 1, maxAmount}, {"882346125300012378005", 2, maxAmount}, {"882346125300012378005", 3, -0.01} });
+    EXPECT_DOUBLE_EQ((2 * 7036874417766399.0 - 1.0) / 300.0, db.calculateAverageAmount("882346125300012378005"));
+
+    //amounts which aren't whole cents aren't loaded or appended
+    EXPECT_THROW(db.setTransactions({ {"882346125300012378005", 1, 1.005} }), AmountException);
+    db.setTransactions({ {"882346125300012378005", 1, 1.00} });
+    EXPECT_THROW(db.appendTransactions({ {"882346125300012378005", 2, 3.00}, {"35200442300000123", 1, 1e300} }), AmountException);
+    EXPECT_EQ(1, db.findTransactions("882346125300012378005").size());
+    EXPECT_THROW(db.calculateAverageAmount("35200442300000123"), AccountException);
+
+    db.appendTransactions({ {"882346125300012378005", 2, 0.1}, {"882346125300012378005", 3, 0.2} });
+    EXPECT_DOUBLE_EQ(1.3 / 3.0, db.calculateAverageAmount("882346125300012378005"));
+
+    //parallel loading reports invalid amount after all threads finish
+    TransactionStore parallelDb(4);
+    parallelDb.setFixedPointAmounts(true);
+    std::vector<Transaction> transactions = transactionsSet1;
+    transactions.push_back({ "882346125300012378005", 7, 0.001 });
+    EXPECT_THROW(parallelDb.setTransactions(transactions), AmountException);
+
+    //range sums use exact prefix sums of cents, cents cancelled by the biggest amounts aren't lost
+    transactions.clear();
+    for(unsigned int i = 0; i < 1000; ++i)
+    {
+        int64_t amountCents = (i % 2 == 0) ? 7036874417766399 : -7036874417766399 + i % 10;
+        transactions.push_back({ "882346125300012378005", i, static_cast<double>(amountCents) / 100.0 });
+    }
+
+    db.setTransactions(transactions);
+    EXPECT_EQ(0.25, db.calculateRangeAggregate("882346125300012378005", 0, 10).sum);
+    EXPECT_EQ(0.025, db.calculateAverageAmount("882346125300012378005", 500, 520));
+    EXPECT_EQ(maxAmount, db.calculateRangeAggregate("882346125300012378005", 500, 501).sum);
+
+    //sums and averages of cents are correctly rounded (dividing rounded quotient would be one ulp off here)
+    EXPECT_EQ(-10423978513.457254, averageOfCents(-857893431657532, 823));
+    EXPECT_EQ(4396131619.504525, averageOfCents(115618261592969, 263));
+    EXPECT_EQ(7977749273915723.0, sumOfCents(797774927391572260));
+    EXPECT_EQ(-0.01, sumOfCents(-1));
+    EXPECT_EQ(0.0, averageOfCents(0, 5));
+    EXPECT_EQ(0.0, averageOfCents(5, 0));
+
+    //sparse prefix sums give exact sums of any range
+    std::mt19937_64 gen(20);
+    std::vector<int64_t> centsColumn(1000);
+    for(int64_t& value : centsColumn)
+        value = static_cast<int64_t>(gen() % 7036874417766399) - ((gen() % 2 == 0) ? 0 : 7036874417766399);
+
+    CentsPrefixSums prefixSums;
+    prefixSums.build(centsColumn.data(), centsColumn.size());
+    for(int i = 0; i < 1000; ++i)
+    {
+        size_t first = gen() % (centsColumn.size() + 1), last = gen() % (centsColumn.size() + 1);
+        if(first > last) std::swap(first, last);
+
+        const CentsSum exactSum = sumCents(centsColumn.data() + first, last - first);
+        ASSERT_EQ(sumOfCents(exactSum), prefixSums.sum(centsColumn.data(), first, last));
+        ASSERT_EQ(averageOfCents(exactSum, last - first), prefixSums.average(centsColumn.data(), first, last));
+    }
+}
+
+TEST(txTests, columnArena)
+{
+    ColumnArena arena;
+    arena.reserve(4 * sizeof(unsigned int) + 2 * sizeof(double));
+
+    TxNoColumn txNos{ ArenaAllocator<unsigned int>(&arena) };
+    txNos.reserve(3);
+    AmountColumn amounts{ ArenaAllocator<double>(&arena) };
+    amounts.reserve(2);
+
+    //exactly reserved columns fit in one slab, second one is aligned
+    EXPECT_EQ(4 * sizeof(unsigned int) + 2 * sizeof(double), arena.memoryUsage());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(amounts.data()) % alignof(double));
+    EXPECT_EQ(reinterpret_cast<const char*>(txNos.data()) + 4 * sizeof(unsigned int), reinterpret_cast<const char*>(amounts.data()));
+
+    //allocation beyond reserved size takes new slab, copies are on heap
+    txNos.assign({ 1, 2, 3, 4 });
+    EXPECT_LT(4 * sizeof(unsigned int) + 2 * sizeof(double), arena.memoryUsage());
+
+    TxNoColumn copy(txNos);
+    EXPECT_EQ(nullptr, copy.get_allocator().getArena());
+    EXPECT_EQ(txNos, copy);
+}
+
+TEST(txTests, arenaColumns)
+{
+    for(unsigned int threads : { 1u, 4u })
+    {
+        TransactionStore db(threads), heapDb(threads);
+        EXPECT_FALSE(db.getArenaColumns());
+        db.setArenaColumns(true);
+
+        for(const auto* transactions : { &transactionsSet1, &transactionsSet2 })
+        {
+            db.setTransactions(*transactions);
+            heapDb.setTransactions(*transactions);
+
+            EXPECT_EQ(heapDb.getStats().transactionsCount, db.getStats().transactionsCount);
+
+            for(const Transaction& trans : *transactions)
+            {
+                EXPECT_EQ(heapDb.findTransactions(trans.accNo).size(), db.findTransactions(trans.accNo).size());
+                EXPECT_EQ(heapDb.calculateAverageAmount(trans.accNo), db.calculateAverageAmount(trans.accNo));
+                EXPECT_EQ(heapDb.findTransaction(trans.accNo, trans.txNo).amount, db.findTransaction(trans.accNo, trans.txNo).amount);
+            }
+        }
+
+        EXPECT_THROW(db.setTransactions({ {"35200442300000123", 1, 1.00}, {"invalid!", 2, 2.00} }), AccountException);
+
+        //appends merge arena's columns into heap ones, also in copied snapshot
+        db.setTransactions(transactionsSet1);
+        db.appendTransactions({ {"7230600000000200006669", 7240, 7240.00}, {"35200442300000123", 1, 1.00} });
+        db.setConcurrentReads(true);
+        db.appendTransactions({ {"4830600000000200003900", 4831, 4831.00} });
+
+        EXPECT_EQ(7, db.findTransactions("7230600000000200006669").size());
+        EXPECT_EQ(1.00, db.calculateAverageAmount("35200442300000123"));
+        EXPECT_EQ(4830.50, db.calculateAverageAmount("4830600000000200003900"));
+        EXPECT_EQ(5611.00, db.findTransaction("56102055610000310200008433", 5611).amount);
+
+        //indexes of big accounts are built in arena too, in both amounts modes
+        std::vector<Transaction> bigAccount;
+        for(unsigned int txNo = 0; txNo < 5000; ++txNo)
+            bigAccount.push_back({ "35200442300000123", txNo * 7 + txNo % 5, static_cast<double>(txNo % 97) - 48.25 });
+
+        for(bool fixedPoint : { false, true })
+        {
+            db.setFixedPointAmounts(fixedPoint);
+            heapDb.setFixedPointAmounts(fixedPoint);
+            db.setTransactions(bigAccount);
+            heapDb.setTransactions(bigAccount);
+
+            for(unsigned int txNo : { 0u, 700u, 9999u, 34997u })
+                EXPECT_EQ(heapDb.findTransaction("35200442300000123", txNo).amount, db.findTransaction("35200442300000123", txNo).amount);
+
+            AmountRangeAggregate expected = heapDb.calculateRangeAggregate("35200442300000123", 100, 30000);
+            AmountRangeAggregate aggregate = db.calculateRangeAggregate("35200442300000123", 100, 30000);
+            EXPECT_EQ(expected.count, aggregate.count);
+            EXPECT_EQ(expected.sum, aggregate.sum);
+            EXPECT_EQ(expected.minAmount, aggregate.minAmount);
+            EXPECT_EQ(expected.maxAmount, aggregate.maxAmount);
+        }
+    }
+}
+
+TEST(txTests, txNoRadixSorter)
+{
+    std::mt19937_64 gen(21);
+    TxNoRadixSorter sorter;
+
+    for(size_t count : { 0, 1, 63, 64, 1000, 100000 })
+    {
+        for(unsigned int range : { 10u, 100000u, std::numeric_limits<unsigned int>::max() })
+        {
+            std::vector<unsigned int> txNos(count);
+            std::vector<double> amounts(count);
+            for(size_t i = 0; i < count; ++i)
+            {
+                txNos[i] = static_cast<unsigned int>(gen() % range) + ((range == 10u) ? 70000u : 0u);
+                amounts[i] = static_cast<double>(i);           //loading order, checks stability
+            }
+
+            std::vector<std::pair<unsigned int, double> > expected;
+            for(size_t i = 0; i < count; ++i)
+                expected.push_back(std::make_pair(txNos[i], amounts[i]));
+            std::stable_sort(expected.begin(), expected.end(),
+                [](const std::pair<unsigned int, double>& first, const std::pair<unsigned int, double>& second){ return first.first < second.first; });
+
+            sorter.sort(txNos.data(), amounts.data(), count);
+
+            for(size_t i = 0; i < count; ++i)
+            {
+                ASSERT_EQ(expected[i].first, txNos[i]) << count << " " << range;
+                ASSERT_EQ(expected[i].second, amounts[i]) << count << " " << range;
+            }
+
+            //sorted rows stay as they are
+            sorter.sort(txNos.data(), amounts.data(), count);
+            EXPECT_TRUE(std::is_sorted(txNos.begin(), txNos.end()));
+        }
+    }
+}
+
+TEST(txTests, radixPartitionLoading)
+{
+    //many accounts with duplicates, so every group is sorted and first loaded duplicate is kept
+    std::mt19937_64 gen(22);
+    std::vector<Transaction> transactions;
+    for(size_t i = 0; i < 20000; ++i)
+    {
+        std::string accNo = "3510204900000099020052" + std::to_string(1000 + gen() % ((i % 2 == 0) ? 4 : 3000));
+        transactions.push_back({ accNo, static_cast<unsigned int>(gen() % 5000), static_cast<double>(i) });
+    }
+
+    for(unsigned int threads : { 1u, 4u })
+    {
+        for(bool arena : { false, true })
+        {
+            TransactionStore expected(threads), db(threads);
+            EXPECT_EQ(LoadAlgorithm::ComparisonSort, db.getLoadAlgorithm());
+            db.setLoadAlgorithm(LoadAlgorithm::RadixPartition);
+            db.setArenaColumns(arena);
+
+            expected.setTransactions(transactions);
+            db.setTransactions(transactions);
+
+            std::vector<Transaction> batch = { {transactions[0].accNo, 6000, 1.00}, {transactions[0].accNo, 5999, 2.00},
+                {transactions[0].accNo, transactions[0].txNo, 3.00}, {"35200442300000123", 1, 1.00} };
+            expected.appendTransactions(batch);
+            db.appendTransactions(batch);
+
+            EXPECT_EQ(expected.getStats().accountsCount, db.getStats().accountsCount);
+            EXPECT_EQ(expected.getStats().transactionsCount, db.getStats().transactionsCount);
+
+            for(const Transaction& trans : transactions)
+            {
+                TransactionsView expectedView = expected.findTransactionsView(trans.accNo), view = db.findTransactionsView(trans.accNo);
+
+                ASSERT_EQ(expectedView.size(), view.size());
+                EXPECT_TRUE(std::equal(expectedView.txNos(), expectedView.txNos() + view.size(), view.txNos()));
+                EXPECT_TRUE(std::equal(expectedView.amounts(), expectedView.amounts() + view.size(), view.amounts()));
+                EXPECT_EQ(expected.calculateAverageAmount(trans.accNo), db.calculateAverageAmount(trans.accNo));
+            }
+        }
+    }
+}
+
+TEST(txTests, accountStats)
+{
+    TransactionStore db;
+    db.setTransactions({ {"35200442300000123", 4, 4.00}, {"35200442300000123", 1, 1.00}, {"35200442300000123", 3, 3.00},
+        {"35200442300000123", 2, 2.00}, {"35200442300000123", 5, 5.00}, {"882346125300012378005", 1, -2.50} });
+
+    AccountStats stats = db.getAccountStats("35200442300000123");
+    EXPECT_EQ(5, stats.count);
+    EXPECT_DOUBLE_EQ(15.0, stats.sum);
+    EXPECT_DOUBLE_EQ(3.0, stats.average);
+    EXPECT_EQ(1.0, stats.minAmount);
+    EXPECT_EQ(5.0, stats.maxAmount);
+    EXPECT_DOUBLE_EQ(2.0, stats.variance);
+    EXPECT_DOUBLE_EQ(std::sqrt(2.0), stats.standardDeviation);
+
+    stats = db.getAccountStats("882346125300012378005");
+    EXPECT_EQ(-2.5, stats.minAmount);
+    EXPECT_EQ(0.0, stats.variance);
+
+    EXPECT_THROW(db.getAccountStats("7230600000000200006669"), AccountException);
+    EXPECT_EQ(LookupStatus::AccountNotFound, db.tryGetAccountStats("invalid!").status);
+
+    //statistics are updated after append
+    db.appendTransactions({ {"35200442300000123", 6, 6.00}, {"35200442300000123", 7, 7.00}, {"35200442300000123", 1, 100.00} });
+    stats = db.getAccountStats("35200442300000123");
+    EXPECT_EQ(7, stats.count);
+    EXPECT_DOUBLE_EQ(4.0, stats.average);
+    EXPECT_EQ(7.0, stats.maxAmount);
+    EXPECT_DOUBLE_EQ(4.0, stats.variance);
+    EXPECT_EQ(db.calculateAverageAmount("35200442300000123"), stats.average);
+
+    //huge amounts, deviations are scaled, so only variance which is beyond double's range is infinite
+    std::vector<Transaction> transactions;
+    for(unsigned int i = 0; i < 1000; ++i)
+        transactions.push_back({ "35200442300000123", i, (i % 2 == 0) ? std::numeric_limits<double>::max() : -std::numeric_limits<double>::max() });
+
+    db.setTransactions(transactions);
+    stats = db.getAccountStats("35200442300000123");
+    EXPECT_EQ(0.0, stats.average);
+    EXPECT_EQ(0.0, stats.sum);
+    EXPECT_TRUE(std::isinf(stats.variance));
+    EXPECT_DOUBLE_EQ(std::numeric_limits<double>::max(), stats.standardDeviation);
+
+    //exact sum of cents in fixed-point mode
+    db.setFixedPointAmounts(true);
+    db.setTransactions(transactionsSet1);
+    stats = db.getAccountStats("7230600000000200006669");
+    EXPECT_EQ(db.calculateAverageAmount("7230600000000200006669"), stats.average);
+    EXPECT_DOUBLE_EQ(stats.average * static_cast<double>(stats.count), stats.sum);
+    EXPECT_EQ(7234.0, stats.minAmount);
+    EXPECT_EQ(7239.0, stats.maxAmount);
+}
+
+TEST(txTests, globalAggregates)
+{
+    //accounts with i % 7 + 1 transactions, more accounts than one scan block
+    std::vector<Transaction> transactions;
+    for(unsigned int i = 0; i < 2000; ++i)
+    {
+        std::string accNo = "35102049" + std::string(14, '0') + std::to_string(1000 + i);
+        for(unsigned int tx = 0; tx <= i % 7; ++tx)
+            transactions.push_back({ accNo, tx, static_cast<double>(i % 100) - 50.0 + tx * 0.25 });
+    }
+
+    TransactionStore db, parallelDb(4);
+    db.setTransactions(transactions);
+    parallelDb.setTransactions(transactions);
+
+    double sum = 0.0;
+    for(const Transaction& trans : transactions)
+        sum += trans.amount;
+
+    GlobalAggregate aggregate = db.calculateGlobalAggregate(), parallelAggregate = parallelDb.calculateGlobalAggregate();
+    EXPECT_EQ(2000, aggregate.accountsCount);
+    EXPECT_EQ(transactions.size(), aggregate.transactionsCount);
+    EXPECT_DOUBLE_EQ(sum, aggregate.sum);
+    EXPECT_DOUBLE_EQ(sum / transactions.size(), aggregate.average);
+    EXPECT_EQ(-50.0, aggregate.minAmount);
+    EXPECT_EQ(50.5, aggregate.maxAmount);
+    EXPECT_EQ(aggregate.transactionsCount, parallelAggregate.transactionsCount);
+    EXPECT_DOUBLE_EQ(aggregate.sum, parallelAggregate.sum);
+    EXPECT_EQ(aggregate.maxAmount, parallelAggregate.maxAmount);
+
+    //exact sum of cents in fixed-point mode
+    parallelDb.setFixedPointAmounts(true);
+    parallelDb.setTransactions(transactions);
+    parallelAggregate = parallelDb.calculateGlobalAggregate();
+    EXPECT_DOUBLE_EQ(sum, parallelAggregate.sum);
+    EXPECT_EQ(aggregate.transactionsCount, parallelAggregate.transactionsCount);
+
+    //ties are ordered by account number, regardless of threads count
+    std::vector<RankedAccount> top = db.findTopAccounts(3, AccountRanking::TransactionsCount);
+    ASSERT_EQ(3, top.size());
+    EXPECT_EQ("35102049000000000000001006", top[0].accNo);
+    EXPECT_EQ("35102049000000000000001013", top[1].accNo);
+    EXPECT_EQ(7, top[2].stats.count);
+
+    for(AccountRanking ranking : { AccountRanking::TransactionsCount, AccountRanking::TotalAmount, AccountRanking::AverageAmount })
+    {
+        std::vector<RankedAccount> parallelTop = parallelDb.findTopAccounts(50, ranking);
+        top = db.findTopAccounts(50, ranking);
+        ASSERT_EQ(50, parallelTop.size());
+        for(size_t i = 0; i < top.size(); ++i)
+            EXPECT_EQ(top[i].accNo, parallelTop[i].accNo);
+    }
+
+    top = db.findTopAccounts(1, AccountRanking::AverageAmount);
+    EXPECT_DOUBLE_EQ(49.75, top[0].stats.average);
+    EXPECT_EQ(2000, db.findTopAccounts(5000, AccountRanking::TotalAmount).size());
+    EXPECT_TRUE(db.findTopAccounts(0, AccountRanking::TotalAmount).empty());
+
+    //buckets of 10 in [-50, 50), the biggest amounts are above
+    AmountHistogram histogram = parallelDb.calculateAmountHistogram(-50.0, 50.0, 10);
+    size_t histogramCount = histogram.getBelowCount() + histogram.getAboveCount();
+    for(size_t bucket = 0; bucket < histogram.getBucketsCount(); ++bucket)
+    {
+        histogramCount += histogram.getCount(bucket);
+        EXPECT_EQ(db.calculateAmountHistogram(-50.0, 50.0, 10).getCount(bucket), histogram.getCount(bucket));
+    }
+
+    EXPECT_EQ(transactions.size(), histogramCount);
+    EXPECT_EQ(0, histogram.getBelowCount());
+    size_t aboveCount = 0, firstBucketCount = 0;
+    for(const Transaction& trans : transactions)
+    {
+        aboveCount += (trans.amount >= 50.0);
+        firstBucketCount += (trans.amount < -40.0);
+    }
+
+    EXPECT_EQ(aboveCount, histogram.getAboveCount());
+    EXPECT_EQ(firstBucketCount, histogram.getCount(0));
+    EXPECT_THROW(db.calculateAmountHistogram(1.0, 1.0, 10), std::invalid_argument);
+    EXPECT_THROW(db.calculateAmountHistogram(0.0, 1.0, 0), std::invalid_argument);
+
+    //amounts close to double's limit
+    AmountHistogram wide(-std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), 2);
+    const double amounts[] = { -std::numeric_limits<double>::max(), -std::numeric_limits<double>::max() / 4.0, 0.0, std::numeric_limits<double>::max(), std::numeric_limits<double>::quiet_NaN() };
+    wide.add(amounts, 5);
+    EXPECT_EQ(2, wide.getCount(0));
+    EXPECT_EQ(1, wide.getCount(1));
+    EXPECT_EQ(1, wide.getAboveCount());
+    EXPECT_EQ(1, wide.getBelowCount());
+
+    //empty store
+    TransactionStore empty;
+    aggregate = empty.calculateGlobalAggregate();
+    EXPECT_EQ(0, aggregate.transactionsCount);
+    EXPECT_EQ(0.0, aggregate.average);
+    EXPECT_TRUE(std::isnan(aggregate.minAmount));
+    EXPECT_TRUE(empty.findTopAccounts(10, AccountRanking::TransactionsCount).empty());
+}
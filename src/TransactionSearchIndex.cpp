@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <limits>
+#include "TransactionSearchIndex.h"
+
+const size_t TransactionSearchIndex::binarySearchLimit;
+const size_t TransactionSearchIndex::maxInterpolationError;
+const size_t TransactionSearchIndex::blockSize;
+
+void TransactionSearchIndex::build(const unsigned int* txNos, size_t count, ColumnArena* arena)
+{
+    kind = Kind::Binary;
+    maxError = 0;
+    blocksCount = 0;
+    treeHeight = 0;
+    ArenaVector<unsigned int>(ArenaAllocator<unsigned int>(arena)).swap(separators);
+
+    if(count < binarySearchLimit) return;
+
+    //largest distance between predicted and real position of any txNo
+    size_t error = 0;
+    for(size_t i = 0; i < count && error <= maxInterpolationError; ++i)
+    {
+        size_t predicted = predictPosition(txNos, count, txNos[i]);
+        error = std::max(error, (predicted > i) ? predicted - i : i - predicted);
+    }
+
+    if(error <= maxInterpolationError)
+    {
+        kind = Kind::Interpolation;
+        maxError = static_cast<uint32_t>(error);
+        return;
+    }
+
+    //perfect tree, so in-order position of node can be calculated from its index
+    blocksCount = (count + blockSize - 1) / blockSize;
+    while((size_t(1) << treeHeight) - 1 < blocksCount)
+        ++treeHeight;
+
+    separators.resize(size_t(1) << treeHeight);
+
+    size_t block = 0;
+    fillEytzinger(txNos, block, 1);
+
+    kind = Kind::Eytzinger;
+}
+
+//in-order walk of the implicit tree assigns separators in ascending order, nodes after the last block
+//get max value, so search never goes left to them [complexity: O(n/blockSize)]
+void TransactionSearchIndex::fillEytzinger(const unsigned int* txNos, size_t& block, size_t node)
+{
+    if(node >= separators.size()) return;
+
+    fillEytzinger(txNos, block, 2 * node);
+
+    separators[node] = (block < blocksCount) ? txNos[block * blockSize] : std::numeric_limits<unsigned int>::max();
+    ++block;
+
+    fillEytzinger(txNos, block, 2 * node + 1);
+}
+
+size_t TransactionSearchIndex::find(const unsigned int* txNos, size_t count, unsigned int txNo) const
+{
+    switch(kind)
+    {
+    case Kind::Interpolation:
+        return findInterpolation(txNos, count, txNo);
+    case Kind::Eytzinger:
+        return findEytzinger(txNos, count, txNo);
+    default:
+        break;
+    }
+
+    const unsigned int* transIt = std::lower_bound(txNos, txNos + count, txNo);
+
+    return (transIt != txNos + count && *transIt == txNo) ? static_cast<size_t>(transIt - txNos) : count;
+}
+
+void TransactionSearchIndex::prefetch(const unsigned int* txNos, size_t count, unsigned int txNo) const
+{
+    if(count == 0) return;
+
+    switch(kind)
+    {
+    case Kind::Interpolation:
+        __builtin_prefetch(txNos + predictPosition(txNos, count, txNo));
+        break;
+    case Kind::Eytzinger:
+        __builtin_prefetch(separators.data() + 1);
+        break;
+    default:
+        __builtin_prefetch(txNos + count / 2);
+        break;
+    }
+}
+
+//linear interpolation between the first and the last txNo, calculated on integers so build and search agree
+size_t TransactionSearchIndex::predictPosition(const unsigned int* txNos, size_t count, unsigned int txNo)
+{
+    const unsigned int first = txNos[0], last = txNos[count - 1];
+
+    if(txNo <= first) return 0;
+    if(txNo >= last) return count - 1;
+
+    return static_cast<size_t>(static_cast<uint64_t>(txNo - first) * (count - 1) / (last - first));
+}
+
+//[complexity: O(log(maxError))]
+size_t TransactionSearchIndex::findInterpolation(const unsigned int* txNos, size_t count, unsigned int txNo) const
+{
+    if(txNo < txNos[0] || txNo > txNos[count - 1]) return count;
+
+    const size_t predicted = predictPosition(txNos, count, txNo);
+    const unsigned int* first = txNos + ((predicted > maxError) ? predicted - maxError : 0);
+    const unsigned int* last = txNos + std::min(count, predicted + maxError + 1);
+
+    const unsigned int* transIt = std::lower_bound(first, last, txNo);
+
+    return (transIt != last && *transIt == txNo) ? static_cast<size_t>(transIt - txNos) : count;
+}
+
+//searching the last block starting at or before txNo, then txNo inside that block [complexity: O(log(n))]
+size_t TransactionSearchIndex::findEytzinger(const unsigned int* txNos, size_t count, unsigned int txNo) const
+{
+    const unsigned int* tree = separators.data();
+    const size_t nodesCount = separators.size() - 1;
+
+    //one 64 bytes line has 16 nodes, which are 4 levels below the current one
+    size_t node = 1;
+    while(node <= nodesCount)
+    {
+        __builtin_prefetch(tree + 16 * node);
+        node = 2 * node + (tree[node] <= txNo);
+    }
+
+    //going back up to the last left turn gives the first separator greater than txNo (0 if there's none)
+    node >>= __builtin_ffsll(static_cast<long long>(~node));
+
+    //in-order position of node in perfect tree, which is the number of the separator's block
+    size_t firstGreater = blocksCount;
+    if(node != 0)
+    {
+        unsigned int depth = 63 - __builtin_clzll(node);
+        firstGreater = std::min(blocksCount, (((node - (size_t(1) << depth)) * 2 + 1) << (treeHeight - 1 - depth)) - 1);
+    }
+
+    if(firstGreater == 0) return count;
+
+    const size_t block = firstGreater - 1;
+
+    const size_t first = block * blockSize, last = std::min(count, first + blockSize);
+
+    //counting smaller txNos in block without branches
+    size_t position = first;
+    for(size_t i = first; i < last; ++i)
+        position += (txNos[i] < txNo);
+
+    return (position != last && txNos[position] == txNo) ? position : count;
+}
@@ -1,170 +1,1277 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <cmath>
 #include "TransactionStore.h"
+#include "SnapshotFile.h"
+
+namespace
+{
+    //number of batch lookups which memory is prefetched together, enough to cover memory latency with few misses in flight
+    const size_t lookupBlockSize = 16;
+
+    //number of accounts which thread takes at once in store-wide scans
+    const size_t scanBlockSize = 256;
+
+    //accounts ahead of the scanned one which columns are prefetched
+    const size_t scanPrefetchDistance = 8;
+
+    //filters rebuilt by appends are sized for this many times more than the current data, so growing store rebuilds
+    //them only after its size is multiplied again (O(1) amortized per appended transaction)
+    const size_t filterGrowthFactor = 2;
+}
 
 Transaction TransactionStore::findTransaction(const std::string &accNo, int txNo) 
 {
-    if(txNo < 0) throw TransactionException(accNo, txNo); 
+    TransactionLookup result = tryFindTransaction(accNo, txNo);
+
+    if(result.status == LookupStatus::AccountNotFound) throw AccountException(accNo);
+    if(result.status == LookupStatus::TransactionNotFound) throw TransactionException(accNo, txNo);
+
+    return std::move(result.transaction);
+}
+
+TransactionLookup TransactionStore::tryFindTransaction(const std::string &accNo, int txNo)
+{
+    if(txNo < 0) return TransactionLookup{ LookupStatus::TransactionNotFound, Transaction{} };
+
+    AccountKey key;
+    if(!key.assign(accNo.data(), accNo.size())) return TransactionLookup{ LookupStatus::AccountNotFound, Transaction{} };
+
+    ReadGuard guard;
+    const StoreSnapshot& current = currentSnapshot();
+    const uint64_t hash = key.hash();
+
+    const AccountTransactions* account = findAccount(current, key, hash);
 
-    auto accIt = getAccount(accNo);
-    
-    auto transIt = transactionBinarySearch(accIt, static_cast<unsigned int>(txNo));
+    if(account == nullptr) return TransactionLookup{ LookupStatus::AccountNotFound, Transaction{} };
 
-    return *(transIt);
+    //transaction rejected by filter isn't searched in account's transactions
+    size_t transIndex = account->txNos.size();
+    if(current.transactionsFilter.mayContain(BlockedBloomFilter::transactionHash(hash, static_cast<unsigned int>(txNo))))
+        transIndex = findTransactionIndex(*account, static_cast<unsigned int>(txNo));
+
+    if(transIndex == account->txNos.size()) return TransactionLookup{ LookupStatus::TransactionNotFound, Transaction{} };
+
+    return TransactionLookup{ LookupStatus::Found, Transaction{ account->accNo.toString(), account->txNos[transIndex], account->amounts[transIndex] } };
+}
+
+//retrieving account from collection by account number, null if there's no such account [complexity: mostly O(1)]
+//has to be called with read guard
+const AccountTransactions* TransactionStore::findAccount(const std::string& accNo) const
+{
+    AccountKey key;
+
+    return key.assign(accNo.data(), accNo.size()) ? findAccount(currentSnapshot(), key, key.hash()) : nullptr;
+}
+
+//account rejected by accounts' filter isn't searched in the table [complexity: mostly O(1)]
+const AccountTransactions* TransactionStore::findAccount(const StoreSnapshot& snapshot, const AccountKey& key, uint64_t hash)
+{
+    if(!snapshot.accountsFilter.mayContain(hash)) return nullptr;
+
+    return snapshot.accounts.find(key, hash);
+}
+
+//search with account's index returning transactions count if there's no such transaction [complexity: O(log(n))]
+size_t TransactionStore::findTransactionIndex(const AccountTransactions& account, unsigned int txNo)
+{
+    return account.searchIndex.find(account.txNos.data(), account.txNos.size(), txNo);
 }
 
-//retrieving account from collection by account number [complexity: mostly O(1)]
-TransactionStore::AccountsMap::iterator TransactionStore::getAccount(const std::string& accNo)
+//finding block of accounts (at most lookupBlockSize), missing ones are null, has to be called with read guard
+//first all keys' table groups are prefetched, then their records and only then lookups are resolved [complexity: mostly O(n)]
+void TransactionStore::findAccountsBlock(const std::string* const* accNos, size_t count, const AccountTransactions** accounts) const
 {
-    auto accIt = accounts.find(accNo);
+    const StoreSnapshot& current = currentSnapshot();
+    const AccountsMap& accountsMap = current.accounts;
 
-    if(accIt != accounts.end())
+    AccountKey keys[lookupBlockSize];
+    uint64_t hashes[lookupBlockSize];
+    bool valid[lookupBlockSize];
+
+    //accounts rejected by filter aren't prefetched nor searched
+    for(size_t i = 0; i < count; ++i)
     {
-        return accIt;
+        valid[i] = keys[i].assign(accNos[i]->data(), accNos[i]->size());
+        hashes[i] = keys[i].hash();
+        valid[i] = valid[i] && current.accountsFilter.mayContain(hashes[i]);
+        if(valid[i]) accountsMap.prefetch(hashes[i]);
     }
-    else
+
+    for(size_t i = 0; i < count; ++i)
+        if(valid[i]) accountsMap.prefetchRecords(hashes[i]);
+
+    for(size_t i = 0; i < count; ++i)
+        accounts[i] = valid[i] ? accountsMap.find(keys[i], hashes[i]) : nullptr;
+}
+
+std::vector<TransactionLookup> TransactionStore::findTransactionBatch(const std::vector<TransactionQuery>& queries)
+{
+    ReadGuard guard;
+    std::vector<TransactionLookup> results(queries.size(), TransactionLookup{ LookupStatus::AccountNotFound, Transaction{} });
+
+    const std::string* accNos[lookupBlockSize];
+    const AccountTransactions* accounts[lookupBlockSize];
+
+    for(size_t first = 0; first < queries.size(); first += lookupBlockSize)
     {
-        throw AccountException(accNo);
-    }    
+        const size_t count = std::min(lookupBlockSize, queries.size() - first);
+
+        for(size_t i = 0; i < count; ++i)
+            accNos[i] = &queries[first + i].accNo;
+
+        findAccountsBlock(accNos, count, accounts);
+
+        //the first memory read by every search
+        for(size_t i = 0; i < count; ++i)
+            if(accounts[i] != nullptr && queries[first + i].txNo >= 0)
+                accounts[i]->searchIndex.prefetch(accounts[i]->txNos.data(), accounts[i]->txNos.size(), static_cast<unsigned int>(queries[first + i].txNo));
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            const TransactionQuery& query = queries[first + i];
+            TransactionLookup& result = results[first + i];
+
+            //same order of checks as in tryFindTransaction
+            if(query.txNo < 0)
+            {
+                result.status = LookupStatus::TransactionNotFound;
+                continue;
+            }
+
+            if(accounts[i] == nullptr) continue;
+
+            const AccountTransactions& account = *accounts[i];
+            size_t transIndex = findTransactionIndex(account, static_cast<unsigned int>(query.txNo));
+
+            if(transIndex == account.txNos.size())
+            {
+                result.status = LookupStatus::TransactionNotFound;
+            }
+            else
+            {
+                result.status = LookupStatus::Found;
+                result.transaction = Transaction{ query.accNo, account.txNos[transIndex], account.amounts[transIndex] };
+            }
+        }
+    }
+
+    return results;
 }
 
-//binary search for account's transaction [complexity: O(log(n))]
-std::vector<Transaction>::iterator TransactionStore::transactionBinarySearch(const AccountsMap::iterator& accountIt, unsigned int txNo)
+std::vector<AverageLookup> TransactionStore::calculateAverageAmountBatch(const std::vector<std::string>& accNos)
 {
-    auto transIt = std::lower_bound(accountIt->second->transactions.begin(), accountIt->second->transactions.end(), txNo, 
-        [](const Transaction& object, int val){ return (object.txNo < val); });
-    
-    //if not transaction found or found transaction is wrong one throw exception
-    if(transIt == accountIt->second->transactions.end() || transIt->txNo != txNo)
-        throw TransactionException(accountIt->second->accNo, txNo);
+    ReadGuard guard;
+    std::vector<AverageLookup> results(accNos.size());
+
+    const std::string* blockAccNos[lookupBlockSize];
+    const AccountTransactions* accounts[lookupBlockSize];
+
+    for(size_t first = 0; first < accNos.size(); first += lookupBlockSize)
+    {
+        const size_t count = std::min(lookupBlockSize, accNos.size() - first);
+
+        for(size_t i = 0; i < count; ++i)
+            blockAccNos[i] = &accNos[first + i];
+
+        findAccountsBlock(blockAccNos, count, accounts);
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            results[first + i] = (accounts[i] != nullptr) ? AverageLookup{ LookupStatus::Found, accounts[i]->stats.average }
+                                                          : AverageLookup{ LookupStatus::AccountNotFound, 0.0 };
+        }
+    }
 
-    return transIt;
+    return results;
 }
 
 std::vector<Transaction> TransactionStore::findTransactions(const std::string &accNo)
 {
-    auto accIt = getAccount(accNo);
+    ReadGuard guard;
+    auto view = findTransactionsView(accNo);
+
+    std::vector<Transaction> transactions;
+    transactions.reserve(view.size());
+
+    for(size_t i = 0; i < view.size(); ++i)
+        transactions.push_back(view[i]);
+
+    return transactions; 
+}
+
+TransactionsView TransactionStore::findTransactionsView(const std::string &accNo)
+{
+    TransactionsLookup result = tryFindTransactionsView(accNo);
+
+    if(result.status != LookupStatus::Found) throw AccountException(accNo);
+
+    return result.transactions;
+}
+
+TransactionsLookup TransactionStore::tryFindTransactionsView(const std::string &accNo)
+{
+    ReadGuard guard;
+    const AccountTransactions* account = findAccount(accNo);
+
+    if(account == nullptr) return TransactionsLookup{ LookupStatus::AccountNotFound, TransactionsView() };
+
+    return TransactionsLookup{ LookupStatus::Found, TransactionsView(account->accNo, account->txNos.data(), account->amounts.data(), account->txNos.size()) };
+}
+
+//positions of the first transaction with txNo >= loTx and the first with txNo >= hiTx [complexity: O(log(n))]
+std::pair<size_t, size_t> TransactionStore::findTransactionsRange(const AccountTransactions& account, unsigned int loTx, unsigned int hiTx)
+{
+    const auto& txNos = account.txNos;
+
+    if(loTx >= hiTx) return std::make_pair(size_t(0), size_t(0));
+
+    auto first = std::lower_bound(txNos.begin(), txNos.end(), loTx);
+    auto last = std::lower_bound(first, txNos.end(), hiTx);
+
+    return std::make_pair(static_cast<size_t>(first - txNos.begin()), static_cast<size_t>(last - txNos.begin()));
+}
+
+TransactionsView TransactionStore::findTransactionsInRange(const std::string &accNo, unsigned int loTx, unsigned int hiTx)
+{
+    ReadGuard guard;
+    const AccountTransactions* account = findAccount(accNo);
+
+    if(account == nullptr) throw AccountException(accNo);
+
+    auto range = findTransactionsRange(*account, loTx, hiTx);
+
+    return TransactionsView(account->accNo, account->txNos.data() + range.first, account->amounts.data() + range.first, range.second - range.first);
+}
+
+AmountRangeAggregate TransactionStore::calculateRangeAggregate(const std::string &accNo, unsigned int loTx, unsigned int hiTx)
+{
+    ReadGuard guard;
+    const AccountTransactions* account = findAccount(accNo);
+
+    if(account == nullptr) throw AccountException(accNo);
+
+    auto range = findTransactionsRange(*account, loTx, hiTx);
+    const double* amounts = account->amounts.data();
+
+    if(range.first == range.second)
+    {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        return AmountRangeAggregate{ 0, 0.0, nan, nan, nan };
+    }
+
+    auto minMax = account->amountRangeTree.minMax(amounts, range.first, range.second);
+
+    if(!account->cents.empty())
+    {
+        const int64_t* cents = account->cents.data();
+
+        return AmountRangeAggregate{ range.second - range.first, account->centsPrefixSums.sum(cents, range.first, range.second),
+            account->centsPrefixSums.average(cents, range.first, range.second), minMax.first, minMax.second };
+    }
+
+    return AmountRangeAggregate{ range.second - range.first, account->amountPrefixSums.sum(amounts, range.first, range.second),
+        account->amountPrefixSums.average(amounts, range.first, range.second), minMax.first, minMax.second };
+}
+
+double TransactionStore::calculateAverageAmount(const std::string &accNo, unsigned int loTx, unsigned int hiTx)
+{
+    AverageLookup result = tryCalculateAverageAmount(accNo, loTx, hiTx);
+
+    if(result.status != LookupStatus::Found) throw AccountException(accNo);
+
+    return result.averageAmount;
+}
+
+AverageLookup TransactionStore::tryCalculateAverageAmount(const std::string &accNo, unsigned int loTx, unsigned int hiTx)
+{
+    ReadGuard guard;
+    const AccountTransactions* account = findAccount(accNo);
+
+    if(account == nullptr) return AverageLookup{ LookupStatus::AccountNotFound, 0.0 };
+
+    auto range = findTransactionsRange(*account, loTx, hiTx);
+
+    if(!account->cents.empty())
+        return AverageLookup{ LookupStatus::Found, account->centsPrefixSums.average(account->cents.data(), range.first, range.second) };
+
+    return AverageLookup{ LookupStatus::Found, account->amountPrefixSums.average(account->amounts.data(), range.first, range.second) };
+}
+
+AccountStats TransactionStore::getAccountStats(const std::string &accNo)
+{
+    AccountStatsLookup result = tryGetAccountStats(accNo);
+
+    if(result.status != LookupStatus::Found) throw AccountException(accNo);
+
+    return result.stats;
+}
+
+AccountStatsLookup TransactionStore::tryGetAccountStats(const std::string &accNo)
+{
+    ReadGuard guard;
+    const AccountTransactions* account = findAccount(accNo);
 
-    return accIt->second->transactions; 
+    if(account == nullptr) return AccountStatsLookup{ LookupStatus::AccountNotFound, AccountStats() };
+
+    return AccountStatsLookup{ LookupStatus::Found, account->stats };
+}
+
+//blocks are aggregated locally and added to thread's aggregate, threads' aggregates are merged by calling thread
+//(which holds read guard of the snapshot for all threads)
+GlobalAggregate TransactionStore::calculateGlobalAggregate()
+{
+    ReadGuard guard;
+    const StoreSnapshot& current = currentSnapshot();
+    const AccountsMap& accounts = current.accounts;
+    const unsigned int count = threadsCount;
+
+    std::vector<AmountAggregate> aggregates(count);
+    std::vector<CentsSum> centsSums(count, 0);
+    std::vector<double> minAmounts(count, std::numeric_limits<double>::infinity()), maxAmounts(count, -std::numeric_limits<double>::infinity());
+
+    scanAccountsInThreads(count, accounts.size(), [&](unsigned int thread, size_t first, size_t last){
+        AmountAggregate blockAggregate;
+        CentsSum blockCentsSum = 0;
+        double blockMin = minAmounts[thread], blockMax = maxAmounts[thread];
+
+        for(size_t i = first; i < last; ++i)
+        {
+            const AccountTransactions& account = accounts[i];
+
+            blockAggregate.add(account.amountAggregate);
+            blockMin = std::min(blockMin, account.stats.minAmount);
+            blockMax = std::max(blockMax, account.stats.maxAmount);
+
+            if(current.fixedPointAmounts)
+                blockCentsSum += sumCents(account.cents.data(), account.cents.size());
+        }
+
+        aggregates[thread].add(blockAggregate);
+        centsSums[thread] += blockCentsSum;
+        minAmounts[thread] = blockMin;
+        maxAmounts[thread] = blockMax;
+    });
+
+    for(unsigned int thread = 1; thread < count; ++thread)
+    {
+        aggregates[0].add(aggregates[thread]);
+        centsSums[0] += centsSums[thread];
+        minAmounts[0] = std::min(minAmounts[0], minAmounts[thread]);
+        maxAmounts[0] = std::max(maxAmounts[0], maxAmounts[thread]);
+    }
+
+    const AmountAggregate& aggregate = aggregates[0];
+    GlobalAggregate result = { accounts.size(), aggregate.count, 0.0, 0.0, minAmounts[0], maxAmounts[0] };
+
+    if(aggregate.count == 0)
+    {
+        result.minAmount = result.maxAmount = std::numeric_limits<double>::quiet_NaN();
+    }
+    else if(current.fixedPointAmounts)
+    {
+        result.sum = sumOfCents(centsSums[0]);
+        result.average = averageOfCents(centsSums[0], aggregate.count);
+    }
+    else
+    {
+        result.sum = std::ldexp(aggregate.sum + aggregate.compensation, -aggregate.scaleExp);
+        result.average = aggregate.average();
+    }
+
+    return result;
+}
+
+//every thread keeps heap of its k best accounts (the worst on top), heaps are merged and sorted at the end
+std::vector<RankedAccount> TransactionStore::findTopAccounts(size_t k, AccountRanking ranking)
+{
+    if(k == 0) return std::vector<RankedAccount>();
+
+    ReadGuard guard;
+    const AccountsMap& accounts = currentSnapshot().accounts;
+    const unsigned int count = threadsCount;
+
+    typedef std::pair<double, size_t> RankedPosition;
+    std::vector<std::vector<RankedPosition> > heaps(count);
+
+    //accounts with bigger value first, then by account number, so the order doesn't depend on threads
+    auto isRankedBefore = [&accounts](const RankedPosition& first, const RankedPosition& second){
+        return (first.first > second.first) || (first.first == second.first && accounts[first.second].accNo < accounts[second.second].accNo);
+    };
+
+    scanAccountsInThreads(count, accounts.size(), [&](unsigned int thread, size_t first, size_t last){
+        std::vector<RankedPosition>& heap = heaps[thread];
+
+        for(size_t i = first; i < last; ++i)
+        {
+            const AccountStats& stats = accounts[i].stats;
+            const double value = (ranking == AccountRanking::TransactionsCount) ? static_cast<double>(stats.count)
+                               : (ranking == AccountRanking::TotalAmount) ? stats.sum : stats.average;
+
+            const RankedPosition position(value, i);
+            if(heap.size() == k && !isRankedBefore(position, heap.front())) continue;
+
+            if(heap.size() == k)
+            {
+                std::pop_heap(heap.begin(), heap.end(), isRankedBefore);
+                heap.pop_back();
+            }
+
+            heap.push_back(position);
+            std::push_heap(heap.begin(), heap.end(), isRankedBefore);
+        }
+    });
+
+    std::vector<RankedPosition> best;
+    for(const auto& heap : heaps)
+        best.insert(best.end(), heap.begin(), heap.end());
+
+    std::sort(best.begin(), best.end(), isRankedBefore);
+    best.resize(std::min(k, best.size()));
+
+    std::vector<RankedAccount> results;
+    results.reserve(best.size());
+
+    for(const RankedPosition& position : best)
+        results.push_back(RankedAccount{ accounts[position.second].accNo.toString(), accounts[position.second].stats });
+
+    return results;
+}
+
+AmountHistogram TransactionStore::calculateAmountHistogram(double minAmount, double maxAmount, size_t bucketsCount)
+{
+    AmountHistogram histogram(minAmount, maxAmount, bucketsCount);
+
+    ReadGuard guard;
+    const AccountsMap& accounts = currentSnapshot().accounts;
+    const unsigned int count = threadsCount;
+
+    std::vector<AmountHistogram> histograms(count, histogram);
+
+    scanAccountsInThreads(count, accounts.size(), [&](unsigned int thread, size_t first, size_t last){
+        for(size_t i = first; i < last; ++i)
+        {
+            //columns of small accounts are scattered on heap, next ones are prefetched while this one is counted
+            if(i + scanPrefetchDistance < last)
+                __builtin_prefetch(accounts[i + scanPrefetchDistance].amounts.data());
+
+            histograms[thread].add(accounts[i].amounts.data(), accounts[i].amounts.size());
+        }
+    });
+
+    for(const AmountHistogram& threadHistogram : histograms)
+        histogram.add(threadHistogram);
+
+    return histogram;
+}
+
+StoreStats TransactionStore::getStats() const
+{
+    ReadGuard guard;
+    const AccountsMap& accounts = currentSnapshot().accounts;
+
+    StoreStats stats = { accounts.size(), 0, 0, 0 };
+
+    stats.filtersMemoryUsage = currentSnapshot().accountsFilter.memoryUsage() + currentSnapshot().transactionsFilter.memoryUsage();
+
+    //hash table with records array and all records' columns
+    stats.memoryUsage = accounts.memoryUsage() + stats.filtersMemoryUsage;
+
+    for(const AccountTransactions& acc : accounts)
+    {
+        stats.transactionsCount += acc.txNos.size();
+        stats.memoryUsage += acc.txNos.capacity() * sizeof(unsigned int) + acc.amounts.capacity() * sizeof(double) + acc.searchIndex.memoryUsage() + acc.amountRangeTree.memoryUsage() + acc.amountPrefixSums.memoryUsage()
+            + acc.cents.capacity() * sizeof(int64_t) + acc.centsPrefixSums.memoryUsage();
+    }
+
+    return stats;
+}
+
+//appending without concurrent reads modifies snapshot in place, so writers are blocked while file is written [complexity: O(n)]
+void TransactionStore::saveSnapshot(const std::string& path) const
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    ReadGuard guard;
+
+    writeSnapshotFile(currentSnapshot(), path);
 }
 
 double TransactionStore::calculateAverageAmount(const std::string &accNo) 
 {
-    auto accIt = getAccount(accNo);
+    AverageLookup result = tryCalculateAverageAmount(accNo);
+
+    if(result.status != LookupStatus::Found) throw AccountException(accNo);
+
+    return result.averageAmount;
+}
+
+AverageLookup TransactionStore::tryCalculateAverageAmount(const std::string &accNo)
+{
+    ReadGuard guard;
+    const AccountTransactions* account = findAccount(accNo);
+
+    if(account == nullptr) return AverageLookup{ LookupStatus::AccountNotFound, 0.0 };
+
+    return AverageLookup{ LookupStatus::Found, account->stats.average };
+}
+
+TransactionStore::TransactionStore(unsigned int threadsCount)
+    : ownedSnapshot(new StoreSnapshot())
+    , snapshot(ownedSnapshot.get())
+    , threadsCount(1)
+    , concurrentReads(false)
+    , filterFalsePositiveRate(0.0)
+    , fixedPointAmounts(false)
+    , arenaColumns(false)
+    , loadAlgorithm(LoadAlgorithm::ComparisonSort)
+{
+    setThreadsCount(threadsCount);
+}
+
+void TransactionStore::setConcurrentReads(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    concurrentReads = enabled;
+}
+
+void TransactionStore::setFilterFalsePositiveRate(double rate)
+{
+    if(!(rate >= 0.0 && rate < 1.0)) throw std::invalid_argument("false positive rate has to be in [0, 1)");
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    filterFalsePositiveRate = rate;
+}
+
+void TransactionStore::setFixedPointAmounts(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    fixedPointAmounts = enabled;
+}
+
+void TransactionStore::setArenaColumns(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    arenaColumns = enabled;
+}
+
+void TransactionStore::setLoadAlgorithm(LoadAlgorithm algorithm)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    loadAlgorithm = algorithm;
+}
+
+//new arena owned by the snapshot, nullptr if columns are allocated on heap
+ColumnArena* TransactionStore::createColumnArena(StoreSnapshot& target) const
+{
+    if(!arenaColumns) return nullptr;
+
+    target.columnArenas.push_back(std::make_shared<ColumnArena>());
+
+    return target.columnArenas.back().get();
+}
+
+//swapping published snapshot, old one is deleted after all queries reading it have finished
+void TransactionStore::publishSnapshot(std::unique_ptr<StoreSnapshot> newSnapshot)
+{
+    std::unique_ptr<StoreSnapshot> oldSnapshot(std::move(ownedSnapshot));
+
+    ownedSnapshot = std::move(newSnapshot);
+    snapshot.store(ownedSnapshot.get());
+
+    EpochDomain::synchronize();
+}
+
+//setting number of threads used by setTransactions and store-wide queries, 0 means one thread per hardware core
+//loading holds writeMutex, so it keeps the count it started with, queries read the count atomically once per call
+void TransactionStore::setThreadsCount(unsigned int count)
+{
+    if(count == 0)
+        count = std::max(std::thread::hardware_concurrency(), 1u);
 
-    return accIt->second->averageAmount;
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    threadsCount = count;
 }
 
 void TransactionStore::setTransactions(const std::vector<Transaction> &transactions)
 {
-    accounts.clear();
+    loadTransactions(transactions, nullptr);
+}
 
-    loadAccountsTransactionData(transactions);
+//taking over the vector, so it's released as soon as its rows are in accounts' columns (before sorting and indexing)
+void TransactionStore::setTransactions(std::vector<Transaction> &&transactions)
+{
+    std::vector<Transaction> consumed(std::move(transactions));
 
-    sortTransactionsData();
+    loadTransactions(consumed, &consumed);
+}
+
+//loading rows into accounts' columns without any per-row allocation, consumed vector is the input to release
+void TransactionStore::loadTransactions(const std::vector<Transaction> &transactions, std::vector<Transaction>* consumed)
+{
+    replaceSnapshot([&](StoreSnapshot& target){
+        if(threadsCount > 1 && transactions.size() >= threadsCount)
+        {
+            loadTransactionsParallel(transactions, target, consumed);
+        }
+        else
+        {
+            loadAccountsTransactionData(transactions, target.accounts, createColumnArena(target));
+
+            if(consumed != nullptr)
+                std::vector<Transaction>().swap(*consumed);
 
-    calculateAveragesOfTransactions();
+            processAccountsData(target.accounts);
+        }
+    });
 }
 
-//loading transactions data to account's collection
-void TransactionStore::loadAccountsTransactionData(const std::vector<Transaction> &transactions)
+void TransactionStore::loadTransactionsFromFile(const std::string& path)
 {
-    for(auto trans : transactions)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) throw std::system_error(errno, std::generic_category(), "can't open transactions file " + path);
+
+    try
+    {
+        loadTransactionsFromDescriptor(fd);
+    }
+    catch(...)
+    {
+        ::close(fd);
+        throw;
+    }
+
+    ::close(fd);
+}
+
+void TransactionStore::loadTransactionsFromDescriptor(int fd)
+{
+    CsvTransactionsReader reader(fd);
+
+    replaceSnapshot([&](StoreSnapshot& target){
+        loadAccountsTransactionData(reader, target.accounts);
+
+        processAccountsData(target.accounts);
+    });
+}
+
+//building new snapshot with given function and publishing it instead of the current one
+void TransactionStore::replaceSnapshot(const std::function<void(StoreSnapshot&)>& load)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    //without concurrent queries old data can be released before loading, so both aren't kept in memory
+    if(!concurrentReads)
+        publishSnapshot(std::unique_ptr<StoreSnapshot>(new StoreSnapshot()));
+
+    std::unique_ptr<StoreSnapshot> newSnapshot(new StoreSnapshot());
+    newSnapshot->fixedPointAmounts = fixedPointAmounts;
+
+    load(*newSnapshot);
+
+    buildFilters(*newSnapshot, 1);
+
+    publishSnapshot(std::move(newSnapshot));
+}
+
+//adding transactions to already loaded ones, transactions duplicating loaded ones (same accNo, txNo) are skipped
+//[complexity: O(m*log(m)) for the batch plus O(n) for every account the batch touches (and its chunk when reads are concurrent)]
+void TransactionStore::appendTransactions(const std::vector<Transaction> &transactions)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    //batch is prepared aside, so invalid account number leaves the store unchanged
+    AccountsMap batchAccounts;
+
+    loadAccountsTransactionData(transactions, batchAccounts, nullptr);
+
+    sortTransactionsData(batchAccounts);
+
+    removeDuplicatedTransactions(batchAccounts);
+
+    //appended amounts follow mode of loaded data
+    if(currentSnapshot().fixedPointAmounts)
+        convertAccountsAmounts(batchAccounts);
+
+    //published snapshot can't be changed when it may be read by other threads, so it's copied,
+    //copy shares unchanged chunks of accounts with it and clones only chunks of accounts the batch touches
+    std::unique_ptr<StoreSnapshot> newSnapshot;
+    if(concurrentReads)
+        newSnapshot.reset(new StoreSnapshot(currentSnapshot()));
+
+    StoreSnapshot& target = concurrentReads ? *newSnapshot : *ownedSnapshot;
+    AccountsMap& accounts = target.accounts;
+
+    for(AccountTransactions& batchAccount : batchAccounts)
+    {
+        AccountTransactions* account = accounts.find(batchAccount.accNo);
+
+        if(account == nullptr)
+        {
+            addToFilters(batchAccount, target);
+            calculateAccountAggregate(batchAccount);
+            buildAccountIndexes(batchAccount);
+            accounts.insert(std::move(batchAccount));
+        }
+        else
+        {
+            mergeAccountTransactions(*account, batchAccount, target);
+        }
+    }
+
+    //filters are rebuilt with room for growth as soon as appends exceed their capacity (and so their false positive rate)
+    if(target.accountsFilter.getAddedCount() > target.accountsFilter.getCapacity()
+        || target.transactionsFilter.getAddedCount() > target.transactionsFilter.getCapacity())
+        buildFilters(target, filterGrowthFactor);
+
+    if(newSnapshot)
+        publishSnapshot(std::move(newSnapshot));
+}
+
+//merging sorted batch into sorted account's transactions, on equal txNo account's transaction is kept [complexity: O(n+m)]
+void TransactionStore::mergeAccountTransactions(AccountTransactions& account, const AccountTransactions& batch, StoreSnapshot& target) const
+{
+    const size_t accountCount = account.txNos.size(), batchCount = batch.txNos.size();
+
+    TxNoColumn txNos;
+    AmountColumn amounts;
+    txNos.reserve(accountCount + batchCount);
+    amounts.reserve(accountCount + batchCount);
+
+    size_t accIndex = 0, batchIndex = 0;
+    const uint64_t accountHash = account.accNo.hash();
+
+    //only inserted transactions are added to filters, duplicates of loaded ones are already there
+    while(accIndex < accountCount || batchIndex < batchCount)
+    {
+        if(batchIndex == batchCount || (accIndex < accountCount && account.txNos[accIndex] <= batch.txNos[batchIndex]))
+        {
+            if(batchIndex < batchCount && account.txNos[accIndex] == batch.txNos[batchIndex])
+                ++batchIndex;                                           //duplicate of already loaded transaction
+
+            txNos.push_back(account.txNos[accIndex]);
+            amounts.push_back(account.amounts[accIndex]);
+            ++accIndex;
+        }
+        else
+        {
+            txNos.push_back(batch.txNos[batchIndex]);
+            amounts.push_back(batch.amounts[batchIndex]);
+            account.amountAggregate.add(batch.amounts[batchIndex]);
+            addToFilters(accountHash, batch.txNos[batchIndex], target);
+            ++batchIndex;
+        }
+    }
+
+    if(txNos.size() == accountCount) return;
+
+    account.txNos.swap(txNos);
+    account.amounts.swap(amounts);
+
+    //batch's amounts were already checked, so conversion of merged column can't fail
+    if(!account.cents.empty())
+        convertAccountAmounts(account);
+
+    updateAccountStats(account);
+    buildAccountIndexes(account);
+}
+
+//building filters for all accounts and transactions of the snapshot with configured false positive rate,
+//filters' capacity is growth times the current counts [complexity: O(n)]
+void TransactionStore::buildFilters(StoreSnapshot& snapshot, size_t growth) const
+{
+    snapshot.accountsFilter.clear();
+    snapshot.transactionsFilter.clear();
+
+    if(filterFalsePositiveRate == 0.0) return;
+
+    //read through const map, so chunks shared with published snapshot aren't cloned
+    const AccountsMap& accounts = snapshot.accounts;
+
+    size_t transactionsCount = 0;
+    for(const AccountTransactions& account : accounts)
+        transactionsCount += account.txNos.size();
+
+    snapshot.accountsFilter.build(accounts.size() * growth, filterFalsePositiveRate);
+    snapshot.transactionsFilter.build(transactionsCount * growth, filterFalsePositiveRate);
+
+    for(const AccountTransactions& account : accounts)
+        addToFilters(account, snapshot);
+}
+
+//adding account and its transactions to snapshot's filters (if they're built)
+void TransactionStore::addToFilters(const AccountTransactions& account, StoreSnapshot& snapshot) const
+{
+    if(!snapshot.accountsFilter.enabled()) return;
+
+    const uint64_t hash = account.accNo.hash();
+    snapshot.accountsFilter.add(hash);
+
+    for(unsigned int txNo : account.txNos)
+        snapshot.transactionsFilter.add(BlockedBloomFilter::transactionHash(hash, txNo));
+}
+
+//adding single transaction of account which is already in snapshot's filters
+void TransactionStore::addToFilters(uint64_t accountHash, unsigned int txNo, StoreSnapshot& snapshot) const
+{
+    if(!snapshot.transactionsFilter.enabled()) return;
+
+    snapshot.transactionsFilter.add(BlockedBloomFilter::transactionHash(accountHash, txNo));
+}
+
+//sorting, removing duplicates and calculating averages for all loaded accounts
+void TransactionStore::processAccountsData(AccountsMap& accountsMap)
+{
+    sortTransactionsData(accountsMap);
+
+    removeDuplicatedTransactions(accountsMap);
+
+    if(fixedPointAmounts)
+        convertAccountsAmounts(accountsMap);
+
+    calculateAveragesOfTransactions(accountsMap);
+
+    buildAccountsIndexes(accountsMap);
+}
+
+//loading transactions data to account's collection, duplicates are removed after sorting [complexity: O(n)]
+//with arena or radix partitioning accounts are created and counted (histogram of rows per account) in the first pass,
+//rows are scattered to columns of exact size, which are contiguous groups of the arena, in the second one
+void TransactionStore::loadAccountsTransactionData(const std::vector<Transaction> &transactions, AccountsMap& accountsMap, ColumnArena* arena)
+{
+    if(arena == nullptr && loadAlgorithm == LoadAlgorithm::ComparisonSort)
+    {
+        for(const Transaction& trans : transactions)
+        {
+            checkAccountNumber(trans.accNo);
+
+            addTransactionToAccount(AccountKey(trans.accNo), trans.txNo, trans.amount, accountsMap);
+        }
+
+        return;
+    }
+
+    std::vector<uint32_t> recordIndexes;
+    recordIndexes.reserve(transactions.size());
+
+    for(const Transaction& trans : transactions)
     {
         checkAccountNumber(trans.accNo);
 
-        auto accountIt = accounts.find(trans.accNo);    
+        recordIndexes.push_back(static_cast<uint32_t>(accountsMap.emplaceIndex(AccountKey(trans.accNo))));
+    }
+
+    reserveExactColumns(accountsMap, recordIndexes, arena);
+
+    for(size_t i = 0; i < transactions.size(); ++i)
+    {
+        AccountTransactions& account = accountsMap[recordIndexes[i]];
+
+        account.txNos.push_back(transactions[i].txNo);
+        account.amounts.push_back(transactions[i].amount);
+    }
+}
+
+//reserving exact capacity of empty columns of all accounts (in arena if it's given), recordIndexes are accounts of transactions
+//[complexity: O(n)]
+void TransactionStore::reserveExactColumns(AccountsMap& accountsMap, const std::vector<uint32_t>& recordIndexes, ColumnArena* arena)
+{
+    std::vector<size_t> counts(accountsMap.size(), 0);
+    for(uint32_t index : recordIndexes)
+        ++counts[index];
+
+    if(arena != nullptr)
+    {
+        //txNos column is padded, so the following amounts are aligned
+        size_t bytes = 0;
+        for(size_t count : counts)
+            bytes += (count * sizeof(unsigned int) + alignof(double) - 1) / alignof(double) * alignof(double) + count * sizeof(double);
+
+        arena->reserve(bytes);
+    }
+
+    for(size_t i = 0; i < counts.size(); ++i)
+    {
+        AccountTransactions& account = accountsMap[i];
 
-        addTransactionToAccount(trans, accountIt);
+        account.txNos = TxNoColumn(ArenaAllocator<unsigned int>(arena));
+        account.txNos.reserve(counts[i]);
+        account.amounts = AmountColumn(ArenaAllocator<double>(arena));
+        account.amounts.reserve(counts[i]);
     }
 }
 
-//checking if account number is correct [1-32 alphanum]
-void TransactionStore::checkAccountNumber(std::string accNo)
+//loading parsed records to account's collection, account numbers are validated like in setTransactions [complexity: O(n)]
+void TransactionStore::loadAccountsTransactionData(CsvTransactionsReader& reader, AccountsMap& accountsMap)
 {
-    const std::pair<int,int> decCharVal(48,57);         //ascii dec values range for all decimals
-    const std::pair<int,int> capitalLetVal(65,90);      //ascii dec values range for capital letters
-    const std::pair<int,int> normalLetVal(97,122);      //ascii dec values range for normal letters
+    TransactionRecord record;
+    AccountKey key;
 
-    if(accNo.size() > 32 || accNo.size() == 0) throw AccountException(accNo);
+    while(reader.next(record))
+    {
+        if(!isAccountNumberValid(record.accNo, record.accNoLength))
+            throw AccountException(std::string(record.accNo, record.accNoLength));
 
-    //checking all letters if they're alphanum signs, if not throw exception
-    std::for_each(accNo.begin(), accNo.end(), [&](char l){ 
-        int charVal = static_cast<int>(l);
+        key.assign(record.accNo, record.accNoLength);
+        addTransactionToAccount(key, record.txNo, record.amount, accountsMap);
+    }
+}
+
+//loading transactions with the accounts hash partitioned between threads [complexity: O(n*log(n)/threads)]
+//every account is handled by exactly one thread, so loading order of its transactions (and first-wins duplicates) is kept
+//rows' positions are counting sorted by partition (stable, so in input order), so every thread reads only its own rows
+//rows are distributed to shards first, so consumed input can be released before threads sort and index their shards
+void TransactionStore::loadTransactionsParallel(const std::vector<Transaction> &transactions, StoreSnapshot& target, std::vector<Transaction>* consumed)
+{
+    const size_t count = transactions.size();
+    const size_t chunkSize = (count + threadsCount - 1) / threadsCount;
+
+    std::vector<unsigned int> partitions(count);
+    std::vector<std::vector<size_t> > partitionCounts(threadsCount, std::vector<size_t>(threadsCount, 0));
+    std::vector<size_t> partitionRows(count);
+    std::vector<AccountsMap> shards(threadsCount);
+    std::vector<size_t> invalidTransactions(threadsCount, count);       //index of first invalid transaction found by each thread
 
-        if(charVal < decCharVal.first) throw AccountException(accNo);
-        else if(charVal > decCharVal.second && charVal < capitalLetVal.first) throw AccountException(accNo);
-        else if(charVal > capitalLetVal.second && charVal < normalLetVal.first) throw AccountException(accNo);
-        else if(charVal > normalLetVal.second) throw AccountException(accNo);
+    //every thread carves its shard's columns from its own arena
+    std::vector<ColumnArena*> arenas(threadsCount);
+    for(ColumnArena*& arena : arenas)
+        arena = createColumnArena(target);
+
+    runInThreads(threadsCount, [&](unsigned int thread){
+        const size_t end = std::min(count, (thread + 1) * chunkSize);
+
+        //upper bits of the hash are used, lower ones choose the group in shard's map
+        for(size_t i = thread * chunkSize; i < end; ++i)
+        {
+            partitions[i] = static_cast<unsigned int>((AccountKey(transactions[i].accNo).hash() >> 32) % threadsCount);
+            ++partitionCounts[thread][partitions[i]];
+        }
     });
+
+    //partition's rows are placed in order of input chunks, so chunk's counts turn to its first positions in partitions
+    size_t offset = 0;
+    std::vector<size_t> partitionBegins(threadsCount + 1);
+    for(unsigned int partition = 0; partition < threadsCount; ++partition)
+    {
+        partitionBegins[partition] = offset;
+        for(unsigned int thread = 0; thread < threadsCount; ++thread)
+        {
+            size_t chunkCount = partitionCounts[thread][partition];
+            partitionCounts[thread][partition] = offset;
+            offset += chunkCount;
+        }
+    }
+    partitionBegins[threadsCount] = offset;
+
+    runInThreads(threadsCount, [&](unsigned int thread){
+        const size_t end = std::min(count, (thread + 1) * chunkSize);
+        std::vector<size_t>& positions = partitionCounts[thread];
+
+        for(size_t i = thread * chunkSize; i < end; ++i)
+            partitionRows[positions[partitions[i]]++] = i;
+    });
+
+    std::vector<unsigned int>().swap(partitions);
+
+    runInThreads(threadsCount, [&](unsigned int thread){
+        AccountsMap& shard = shards[thread];
+        ColumnArena* arena = arenas[thread];
+        const bool grouped = (arena != nullptr || loadAlgorithm == LoadAlgorithm::RadixPartition);
+        const size_t* rowsBegin = partitionRows.data() + partitionBegins[thread];
+        const size_t* rowsEnd = partitionRows.data() + partitionBegins[thread + 1];
+        std::vector<uint32_t> recordIndexes;
+
+        for(const size_t* row = rowsBegin; row != rowsEnd; ++row)
+        {
+            const size_t i = *row;
+            const Transaction& trans = transactions[i];
+
+            try
+            {
+                checkAccountNumber(trans.accNo);
+            }
+            catch(const AccountException&)
+            {
+                invalidTransactions[thread] = i;
+                return;
+            }
+
+            if(!grouped)
+                addTransactionToAccount(AccountKey(trans.accNo), trans.txNo, trans.amount, shard);
+            else
+                recordIndexes.push_back(static_cast<uint32_t>(shard.emplaceIndex(AccountKey(trans.accNo))));
+        }
+
+        if(grouped)
+        {
+            reserveExactColumns(shard, recordIndexes, arena);
+
+            size_t next = 0;
+            for(const size_t* row = rowsBegin; row != rowsEnd; ++row)
+            {
+                AccountTransactions& account = shard[recordIndexes[next++]];
+                account.txNos.push_back(transactions[*row].txNo);
+                account.amounts.push_back(transactions[*row].amount);
+            }
+        }
+    });
+
+    //reporting the same account as serial loading would, which is the first invalid one in the input
+    size_t firstInvalid = *std::min_element(invalidTransactions.begin(), invalidTransactions.end());
+    if(firstInvalid != count) throw AccountException(transactions[firstInvalid].accNo);
+
+    std::vector<size_t>().swap(partitionRows);
+
+    if(consumed != nullptr)
+        std::vector<Transaction>().swap(*consumed);
+
+    //amount not convertible to cents is rethrown by runInThreads after all threads finish
+    runInThreads(threadsCount, [&](unsigned int thread){
+        processAccountsData(shards[thread]);
+    });
+
+    mergeAccountsShards(shards, target.accounts);
 }
 
-//adding single transaction to account
-void TransactionStore::addTransactionToAccount(const Transaction& transaction, AccountsMap::iterator& accountIt)
+//running function in all threads, function gets thread's index
+//exception thrown by any thread (the calling one too) is rethrown after all threads finish, the lowest thread's one wins
+void TransactionStore::runInThreads(unsigned int count, const std::function<void(unsigned int)>& func)
 {
-    if(accountIt == accounts.end())                                 //if account doesn't exist in collection
-        accountIt = createAccount(transaction.accNo);               //create one
+    std::vector<std::exception_ptr> errors(count);
+    auto guardedFunc = [&](unsigned int thread){
+        try
+        {
+            func(thread);
+        }
+        catch(...)
+        {
+            errors[thread] = std::current_exception();
+        }
+    };
 
-    if(!isTransactionDuplicate(transaction, accountIt))             //if transaction isn't duplicate
+    std::vector<std::thread> threads;
+    threads.reserve(count - 1);
+
+    for(unsigned int thread = 1; thread < count; ++thread)
+        threads.emplace_back(guardedFunc, thread);
+
+    guardedFunc(0);
+
+    for(auto& thread : threads)
+        thread.join();
+
+    for(const std::exception_ptr& error : errors)
+        if(error) std::rethrow_exception(error);
+}
+
+//calling func with thread's index and range of accounts' positions for all blocks of accounts, threads take next blocks
+//until all are done (so threads with big accounts take fewer blocks), stores with single block are scanned by calling thread
+void TransactionStore::scanAccountsInThreads(unsigned int count, size_t accountsCount, const std::function<void(unsigned int, size_t, size_t)>& func)
+{
+    if(count == 1 || accountsCount <= scanBlockSize)
     {
-        accountIt->second->transactions.push_back(transaction);     //add it to account's transactions
+        func(0, 0, accountsCount);
+        return;
     }
+
+    std::atomic<size_t> nextBlock(0);
+
+    runInThreads(count, [&](unsigned int thread){
+        for(size_t first = nextBlock.fetch_add(scanBlockSize); first < accountsCount; first = nextBlock.fetch_add(scanBlockSize))
+            func(thread, first, std::min(accountsCount, first + scanBlockSize));
+    });
 }
 
-//creating account and adding it to collection
-TransactionStore::AccountsMap::iterator TransactionStore::createAccount(const std::string& accNo)
+//moving accounts from threads' shards to the main collection, shards contain disjoint sets of accounts
+void TransactionStore::mergeAccountsShards(std::vector<AccountsMap>& shards, AccountsMap& accountsMap)
 {
-    auto accInsertType = accounts.insert(AccountsMap::value_type(accNo, 
-        std::make_unique<AccountTransactions>(accNo)));
+    size_t accountsCount = 0;
+    for(const auto& shard : shards)
+        accountsCount += shard.size();
 
-    if(accInsertType.second)
+    accountsMap.reserve(accountsCount);
+
+    for(auto& shard : shards)
     {
-        return accInsertType.first;
+        for(AccountTransactions& account : shard)
+            accountsMap.insert(std::move(account));
+
+        shard.clear();
     }
-    else
-    {
-        throw AccountException(accNo);          //if account can't be created throw exception
-    }  
 }
 
-//checking if transaction is a duplicate [if transaction with the same number exists in the account's transactions collection]
-bool TransactionStore::isTransactionDuplicate(const Transaction& transaction, const AccountsMap::iterator& accountIt)
+//checking if account number is correct [1-32 alphanum]
+void TransactionStore::checkAccountNumber(const std::string& accNo)
 {
-    auto accountTransactionsIt = std::find_if(accountIt->second->transactions.begin(), accountIt->second->transactions.end(), 
-        [&transaction](const Transaction& val){ return (val.txNo == transaction.txNo); });
+    if(!isAccountNumberValid(accNo)) throw AccountException(accNo);
+}
+
+//adding single transaction to account, account is created if it doesn't exist in collection
+void TransactionStore::addTransactionToAccount(const AccountKey& key, unsigned int txNo, double amount, AccountsMap& accountsMap)
+{
+    AccountTransactions& account = accountsMap.emplace(key);
+
+    account.txNos.push_back(txNo);                                  //add it to account's transactions
+    account.amounts.push_back(amount);
+}
+
+//sorting transactions for all account's by ascending by transaction's number [complexity: O(n*log(n)), O(n) for radix]
+//sort is stable, so transactions with the same number keep their loading order
+void TransactionStore::sortTransactionsData(AccountsMap& accountsMap)
+{
+    if(loadAlgorithm == LoadAlgorithm::RadixPartition)
+    {
+        TxNoRadixSorter sorter;
+
+        for(AccountTransactions& account : accountsMap)
+            sorter.sort(account.txNos.data(), account.amounts.data(), account.txNos.size());
+
+        return;
+    }
 
-    return (accountTransactionsIt != accountIt->second->transactions.end());
+    std::vector<std::pair<unsigned int, double> > rows;
+
+    for(AccountTransactions& account : accountsMap)
+    {
+        auto& txNos = account.txNos;
+        auto& amounts = account.amounts;
+
+        rows.resize(txNos.size());
+        for(size_t i = 0; i < txNos.size(); ++i)
+            rows[i] = std::make_pair(txNos[i], amounts[i]);
+
+        std::stable_sort(rows.begin(), rows.end(), 
+            [](const std::pair<unsigned int, double>& first, const std::pair<unsigned int, double>& second){ return (first.first < second.first); });
+
+        for(size_t i = 0; i < rows.size(); ++i)
+        {
+            txNos[i] = rows[i].first;
+            amounts[i] = rows[i].second;
+        }
+    }
 }
 
-//sorting transactions for all account's by ascending by transaction's number
-void TransactionStore::sortTransactionsData()
+//removing duplicated transactions (same txNo) from sorted account's transactions, first loaded one is kept [complexity: O(n)]
+void TransactionStore::removeDuplicatedTransactions(AccountsMap& accountsMap)
 {
-    for(auto accIt = accounts.begin(); accIt != accounts.end(); ++accIt)
+    for(AccountTransactions& account : accountsMap)
     {
-        std::sort(accIt->second->transactions.begin(), accIt->second->transactions.end(), 
-            [](const Transaction& first, const Transaction& second){ return (first.txNo < second.txNo); });
+        auto& txNos = account.txNos;
+        auto& amounts = account.amounts;
+
+        if(txNos.empty()) continue;
+
+        size_t last = 0;
+        for(size_t i = 1; i < txNos.size(); ++i)
+        {
+            if(txNos[i] == txNos[last]) continue;
+
+            ++last;
+            txNos[last] = txNos[i];
+            amounts[last] = amounts[i];
+        }
+
+        txNos.resize(last + 1);
+        amounts.resize(last + 1);
+
+        //shrinking arena's columns would only take new memory from arena
+        if(txNos.get_allocator().getArena() == nullptr)
+        {
+            txNos.shrink_to_fit();
+            amounts.shrink_to_fit();
+        }
     }
 }
 
 //calculating average of transactions values for all account's
-void TransactionStore::calculateAveragesOfTransactions()
+void TransactionStore::calculateAveragesOfTransactions(AccountsMap& accountsMap)
 {
-    double totalAvg, count;
+    for(AccountTransactions& account : accountsMap)
+    {
+        calculateAccountAggregate(account);
+    }
+}
 
-    for(auto accIt = accounts.begin(); accIt != accounts.end(); ++accIt)
+//building search indexes, range trees and prefix sums of all accounts [complexity: O(n)]
+void TransactionStore::buildAccountsIndexes(AccountsMap& accountsMap)
+{
+    for(AccountTransactions& account : accountsMap)
     {
-        accIt->second->averageAmount = calculateAccountAverage(accIt);
+        buildAccountIndexes(account);
     }
 }
 
-//calculating average value of transactions for single account in respect to double type limits
-double TransactionStore::calculateAccountAverage(const AccountsMap::iterator& accountIt)
+//search method is chosen by transactions count and txNos distribution, prefix sums use scale of account's aggregate
+//indexes are allocated where the columns are (in arena of loaded data, on heap for appended)
+void TransactionStore::buildAccountIndexes(AccountTransactions& account)
 {
-    double totalAvg = 0.0, count = static_cast<double>(accountIt->second->transactions.size());
+    ColumnArena* arena = account.txNos.get_allocator().getArena();
+
+    account.searchIndex.build(account.txNos.data(), account.txNos.size(), arena);
+    account.amountRangeTree.build(account.amounts.data(), account.amounts.size(), arena);
+
+    if(account.cents.empty())
+        account.amountPrefixSums.build(account.amounts.data(), account.amounts.size(), account.amountAggregate.scaleExp, arena);
+    else
+        account.centsPrefixSums.build(account.cents.data(), account.cents.size(), arena);
+}
+
+//calculating sum, average and other statistics of transactions for single account in respect to double type limits
+void TransactionStore::calculateAccountAggregate(AccountTransactions& account)
+{
+    account.amountAggregate = AmountAggregate();
+    account.amountAggregate.add(account.amounts.data(), account.amounts.size());
+
+    updateAccountStats(account);
+}
+
+//sum and average from exact sum of cents in fixed-point mode, otherwise from compensated sum of doubles
+//the rest of statistics from one pass over amounts column
+void TransactionStore::updateAccountStats(AccountTransactions& account)
+{
+    const AmountAggregate& aggregate = account.amountAggregate;
+    double sum, average;
+
+    if(account.cents.empty())
+    {
+        sum = std::ldexp(aggregate.sum + aggregate.compensation, -aggregate.scaleExp);
+        average = aggregate.average();
+    }
+    else
+    {
+        CentsSum centsSum = sumCents(account.cents.data(), account.cents.size());
+        sum = sumOfCents(centsSum);
+        average = averageOfCents(centsSum, account.cents.size());
+    }
+
+    account.stats = calculateAccountStats(account.amounts.data(), account.amounts.size(), aggregate.maxAbs, sum, average);
+}
 
-    for(const Transaction& trans : accountIt->second->transactions)
+//filling cents columns of all accounts, AmountException is thrown for the first amount which isn't whole cents
+void TransactionStore::convertAccountsAmounts(AccountsMap& accountsMap)
+{
+    for(AccountTransactions& account : accountsMap)
     {
-        //if all single transaction amount's values are divided by total count of transactions then the limit of double type will not be exceeded
-        totalAvg += (trans.amount / count);         
+        convertAccountAmounts(account);
     }
+}
+
+//cents column is allocated where amounts column is
+void TransactionStore::convertAccountAmounts(AccountTransactions& account)
+{
+    CentsColumn(account.amounts.size(), 0, ArenaAllocator<int64_t>(account.amounts.get_allocator().getArena())).swap(account.cents);
 
-    return totalAvg;
+    for(size_t i = 0; i < account.amounts.size(); ++i)
+    {
+        if(!amountToCents(account.amounts[i], account.cents[i]))
+            throw AmountException(account.accNo.toString(), account.amounts[i]);
+    }
 }